@@ -210,6 +210,15 @@ void m68k_write_memory_32(m68ki_cpu_core* core, unsigned int address, unsigned i
  */
 void m68k_write_memory_32_pd(m68ki_cpu_core* core, unsigned int address, unsigned int value);
 
+/* Burst transfer of count consecutive values of size bytes (2 or 4) starting at
+ * address, used by MOVEM, 64 bit FPU moves and exception stack frames. values
+ * holds one value per element in ascending address order.
+ * Return zero if the range cannot be served in one go, the core then falls back
+ * to single accesses in the original order.
+ */
+int m68k_read_memory_burst(m68ki_cpu_core* core, unsigned int address, unsigned int count, unsigned int size, unsigned int* values);
+int m68k_write_memory_burst(m68ki_cpu_core* core, unsigned int address, unsigned int count, unsigned int size, const unsigned int* values);
+
 
 
 /* ======================================================================== */
@@ -255,7 +264,7 @@ void m68k_set_reset_instr_callback(m68ki_cpu_core* m68ki_cpu, void  (*callback)(
 
 
 /* Set the callback for informing of a large PC change.
- * You must enable M68K_MONITOR_PC in m68kconf.h.
+ * You must enable M68K_MONITOR_PC in m68kconf.h or m68k_set_monitor_pc().
  * The CPU calls this callback with the new PC value every time the PC changes
  * by a large value (currently set for changes by longwords).
  * Default behavior: do nothing.
@@ -288,7 +297,8 @@ void m68k_set_fc_callback(m68ki_cpu_core* m68ki_cpu, void  (*callback)(m68ki_cpu
 
 
 /* Set a callback for the instruction cycle of the CPU.
- * You must enable M68K_INSTRUCTION_HOOK in m68kconf.h.
+ * You must enable M68K_INSTRUCTION_HOOK in m68kconf.h or use one of the
+ * instrumented execute functions.
  * The CPU calls this callback just before fetching the opcode in the
  * instruction cycle.
  * Default behavior: do nothing.
@@ -323,6 +333,24 @@ void m68k_pulse_reset(m68ki_cpu_core* m68ki_cpu);
 /* execute num_cycles worth of instructions.  returns number of cycles used */
 int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles);
 
+/* Same as m68k_execute(m68ki_cpu, 1) without the run loop: handles pending
+ * interrupts, executes exactly one instruction and returns the cycles used.
+ */
+int m68k_execute_instruction(m68ki_cpu_core* m68ki_cpu);
+
+/* Instrumented variants of the two functions above, they call the instruction
+ * hook callback before each instruction. The plain variants are compiled
+ * without the call, so the choice can be made at runtime without a cost for
+ * the plain ones.
+ */
+int m68k_execute_instrumented(m68ki_cpu_core* m68ki_cpu, int num_cycles);
+int m68k_execute_instruction_instrumented(m68ki_cpu_core* m68ki_cpu);
+
+/* Enables calls of the pc changed callback at runtime if M68K_MONITOR_PC is
+ * off in m68kconf.h.
+ */
+void m68k_set_monitor_pc(m68ki_cpu_core* m68ki_cpu, int enable);
+
 /* These functions let you read/write/modify the number of cycles left to run
  * while m68k_execute() is running.
  * These are useful if the 68k accesses a memory-mapped port on another device
@@ -378,6 +406,53 @@ unsigned int m68k_get_reg(const void* context, m68k_register_t reg);
 /* Poke values into the internals of the currently running CPU context */
 void m68k_set_reg(m68ki_cpu_core* m68ki_cpu, m68k_register_t reg, unsigned int value);
 
+/* Serve immediate reads (opcodes and extension words) within [address, address+size)
+ * directly from host memory instead of calling m68k_read_immediate_xx().
+ * The memory has to be in 68k byte order and needs to stay valid while it is set.
+ * Nothing is decoded ahead of time, writes to the memory are visible immediately.
+ * Pass a size of 0 to disable.
+ */
+void m68k_set_code_memory(m68ki_cpu_core* m68ki_cpu, unsigned int address, unsigned int size, const unsigned char* host_memory);
+
+/* Instruction pair fusion for m68k_execute_instruction(). first_opcodes is a
+ * bitmap of 65536 bits, one per opcode. If the executed instruction has its bit
+ * set and is directly followed by a branch (BRA, Bcc or DBcc) in code memory,
+ * the branch is executed in the same call. The returned cycles are the sum of
+ * both. The branch is executed separately if the first instruction caused an
+ * exception, left an interrupt pending or called m68k_break_fusion().
+ * Pass NULL to disable.
+ */
+void m68k_set_fusion_table(m68ki_cpu_core* m68ki_cpu, const unsigned char* first_opcodes);
+
+/* Called from memory callbacks to end the current instruction without fusing
+ * the following branch, for example when a watchpoint has been hit. Also set
+ * by exception processing, nonzero in m68k_get_fusion_break() after an execute
+ * call that processed an exception or called m68k_break_fusion().
+ */
+void m68k_break_fusion(m68ki_cpu_core* m68ki_cpu);
+unsigned int m68k_get_fusion_break(m68ki_cpu_core* m68ki_cpu);
+
+/* Attaches an FPU to a 68020 or 68030 as coprocessor 1, like a 68881/68882.
+ * FPU instructions are then executed by the same emulation as on a 68040
+ * instead of raising a line F exception. A 68040 always has its FPU enabled.
+ */
+void m68k_set_fpu_enabled(m68ki_cpu_core* m68ki_cpu, int enable);
+
+/* Selects how FADD, FSUB, FMUL, FDIV, FSQRT and FCMP are computed. By default
+ * softfloat is used, which matches the 80 bit extended precision of the FPU.
+ * If enabled, the operands are converted to host doubles and the result is
+ * converted back, which is much faster but limited to double precision and
+ * always rounds to nearest, ignoring the rounding mode and precision in FPCR.
+ * The FPU registers keep their extended format in both modes.
+ */
+void m68k_set_fpu_host_double(m68ki_cpu_core* m68ki_cpu, int enable);
+
+/* Returns the base cycles of an opcode for the CPU type of the context */
+unsigned int m68k_get_instruction_cycles(m68ki_cpu_core* m68ki_cpu, unsigned int opcode);
+
+/* Returns nonzero if the opcode is a BRA, Bcc or DBcc that can be fused with the preceding instruction */
+unsigned int m68k_is_fusable_branch(unsigned int opcode);
+
 /* Check if an instruction is valid for the specified CPU type */
 unsigned int m68k_is_valid_instruction(unsigned int instruction, unsigned int cpu_type);
 
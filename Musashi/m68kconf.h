@@ -63,12 +63,29 @@
 /* ============================= CONFIGURATION ============================ */
 /* ======================================================================== */
 
+/* If ON, the core is built for the 68020 only. The CPU type becomes a compile
+ * time constant so that all CPU type checks in the opcode handlers fold away and
+ * handlers of other CPU models are reduced to illegal instruction exceptions.
+ * m68k_set_cpu_type() then selects the 68020 regardless of its argument.
+ */
+#ifndef M68K_SPECIALIZE_020
+#define M68K_SPECIALIZE_020         OPT_OFF
+#endif
+
 /* Turn ON if you want to use the following M68K variants */
+#if M68K_SPECIALIZE_020
+#define M68K_EMULATE_010            OPT_OFF
+#define M68K_EMULATE_EC020          OPT_OFF
+#define M68K_EMULATE_020            OPT_ON
+#define M68K_EMULATE_030            OPT_OFF
+#define M68K_EMULATE_040            OPT_OFF
+#else
 #define M68K_EMULATE_010            OPT_ON
 #define M68K_EMULATE_EC020          OPT_ON
 #define M68K_EMULATE_020            OPT_ON
 #define M68K_EMULATE_030            OPT_ON
 #define M68K_EMULATE_040            OPT_ON
+#endif
 
 
 /* If ON, the CPU will call m68k_read_immediate_xx() for immediate addressing
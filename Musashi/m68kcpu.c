@@ -44,8 +44,6 @@
 extern void m68040_fpu_op0(m68ki_cpu_core* m68ki_cpu);
 extern void m68040_fpu_op1(m68ki_cpu_core* m68ki_cpu);
 extern void m68881_mmu_ops(m68ki_cpu_core* m68ki_cpu);
-extern unsigned char m68ki_cycles[][0x10000];
-extern void (*m68ki_instruction_jump_table[0x10000])(m68ki_cpu_core*); /* opcode handler jump table */
 extern void m68ki_build_opcode_table(void);
 
 #include "m68kfpu.c"
@@ -774,16 +772,70 @@ void m68k_set_instr_hook_callback(m68ki_cpu_core* m68ki_cpu, void  (*callback)(m
 	CALLBACK_INSTR_HOOK = callback ? callback : default_instr_hook_callback;
 }
 
+void m68k_set_code_memory(m68ki_cpu_core* m68ki_cpu, unsigned int address, unsigned int size, const unsigned char* host_memory)
+{
+	m68ki_cpu->code_mem = host_memory;
+	m68ki_cpu->code_base = address;
+	m68ki_cpu->code_size = host_memory ? size : 0;
+}
+
+void m68k_set_fusion_table(m68ki_cpu_core* m68ki_cpu, const unsigned char* first_opcodes)
+{
+	m68ki_cpu->fuse_first = first_opcodes;
+}
+
+void m68k_break_fusion(m68ki_cpu_core* m68ki_cpu)
+{
+	m68ki_cpu->fuse_break = 1;
+}
+
+unsigned int m68k_get_fusion_break(m68ki_cpu_core* m68ki_cpu)
+{
+	return m68ki_cpu->fuse_break;
+}
+
+void m68k_set_monitor_pc(m68ki_cpu_core* m68ki_cpu, int enable)
+{
+	m68ki_cpu->monitor_pc = enable ? 1 : 0;
+}
+
+void m68k_set_fpu_enabled(m68ki_cpu_core* m68ki_cpu, int enable)
+{
+	m68ki_cpu->has_fpu = enable ? 1 : 0;
+}
+
+void m68k_set_fpu_host_double(m68ki_cpu_core* m68ki_cpu, int enable)
+{
+	m68ki_cpu->fpu_host_double = enable ? 1 : 0;
+}
+
+unsigned int m68k_get_instruction_cycles(m68ki_cpu_core* m68ki_cpu, unsigned int opcode)
+{
+	(void)m68ki_cpu; /* unused if the core is specialized for one CPU type */
+	return CYC_INSTRUCTION(opcode & 0xffff);
+}
+
+unsigned int m68k_is_fusable_branch(unsigned int opcode)
+{
+	/* BSR (0x61xx) is a call and is not fused */
+	if((opcode & 0xf000) == 0x6000)
+		return (opcode & 0x0f00) != 0x0100;
+	return (opcode & 0xf0f8) == 0x50c8;
+}
+
 /* Set the CPU type. */
 void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 {
+#if M68K_SPECIALIZE_020
+	cpu_type = M68K_CPU_TYPE_68020;
+#endif
 	switch(cpu_type)
 	{
 		case M68K_CPU_TYPE_68000:
-			CPU_TYPE         = CPU_TYPE_000;
+			m68ki_cpu->cpu_type = CPU_TYPE_000;
 			CPU_ADDRESS_MASK = 0x00ffffff;
 			CPU_SR_MASK      = 0xa71f; /* T1 -- S  -- -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[0];
+			m68ki_cpu->cyc_type_index = 0;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[0];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 2;
@@ -799,13 +851,13 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 		case M68K_CPU_TYPE_SCC68070:
 			m68k_set_cpu_type(m68ki_cpu, M68K_CPU_TYPE_68010);
 			CPU_ADDRESS_MASK = 0xffffffff;
-			CPU_TYPE         = CPU_TYPE_SCC070;
+			m68ki_cpu->cpu_type = CPU_TYPE_SCC070;
 			return;
 		case M68K_CPU_TYPE_68010:
-			CPU_TYPE         = CPU_TYPE_010;
+			m68ki_cpu->cpu_type = CPU_TYPE_010;
 			CPU_ADDRESS_MASK = 0x00ffffff;
 			CPU_SR_MASK      = 0xa71f; /* T1 -- S  -- -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[1];
+			m68ki_cpu->cyc_type_index = 1;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[1];
 			CYC_BCC_NOTAKE_B = -4;
 			CYC_BCC_NOTAKE_W = 0;
@@ -819,10 +871,10 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 			HAS_PMMU	 = 0;
 			return;
 		case M68K_CPU_TYPE_68EC020:
-			CPU_TYPE         = CPU_TYPE_EC020;
+			m68ki_cpu->cpu_type = CPU_TYPE_EC020;
 			CPU_ADDRESS_MASK = 0x00ffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[2];
+			m68ki_cpu->cyc_type_index = 2;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[2];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -836,10 +888,10 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 			HAS_PMMU	 = 0;
 			return;
 		case M68K_CPU_TYPE_68020:
-			CPU_TYPE         = CPU_TYPE_020;
+			m68ki_cpu->cpu_type = CPU_TYPE_020;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[2];
+			m68ki_cpu->cyc_type_index = 2;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[2];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -853,10 +905,10 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 			HAS_PMMU	 = 0;
 			return;
 		case M68K_CPU_TYPE_68030:
-			CPU_TYPE         = CPU_TYPE_030;
+			m68ki_cpu->cpu_type = CPU_TYPE_030;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[3];
+			m68ki_cpu->cyc_type_index = 3;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[3];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -870,10 +922,10 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 			HAS_PMMU	       = 1;
 			return;
 		case M68K_CPU_TYPE_68EC030:
-			CPU_TYPE         = CPU_TYPE_EC030;
+			m68ki_cpu->cpu_type = CPU_TYPE_EC030;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK          = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[3];
+			m68ki_cpu->cyc_type_index = 3;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[3];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -887,10 +939,10 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 			HAS_PMMU	       = 0;		/* EC030 lacks the PMMU and is effectively a die-shrink 68020 */
 			return;
 		case M68K_CPU_TYPE_68040:		// TODO: these values are not correct
-			CPU_TYPE         = CPU_TYPE_040;
+			m68ki_cpu->cpu_type = CPU_TYPE_040;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[4];
+			m68ki_cpu->cyc_type_index = 3;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[4];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -904,10 +956,10 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 			HAS_PMMU	 = 1;
 			return;
 		case M68K_CPU_TYPE_68EC040: // Just a 68040 without pmmu apparently...
-			CPU_TYPE         = CPU_TYPE_EC040;
+			m68ki_cpu->cpu_type = CPU_TYPE_EC040;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[4];
+			m68ki_cpu->cyc_type_index = 3;
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[4];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -921,9 +973,9 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 			HAS_PMMU	 = 0;
 			return;
 		case M68K_CPU_TYPE_68LC040:
-			CPU_TYPE         = CPU_TYPE_LC040;
+			m68ki_cpu->cpu_type = CPU_TYPE_LC040;
 			m68ki_cpu->sr_mask          = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			m68ki_cpu->cyc_instruction  = m68ki_cycles[4];
+			m68ki_cpu->cyc_type_index = 3;
 			m68ki_cpu->cyc_exception    = m68ki_exception_cycle_table[4];
 			m68ki_cpu->cyc_bcc_notake_b = -2;
 			m68ki_cpu->cyc_bcc_notake_w = 0;
@@ -941,7 +993,8 @@ void m68k_set_cpu_type(m68ki_cpu_core* m68ki_cpu, unsigned int cpu_type)
 
 /* Execute some instructions until we use up num_cycles clock cycles */
 /* ASG: removed per-instruction interrupt checks */
-int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles)
+/* instrumented is a constant, the plain and the instrumented entry points below get separate loops */
+static inline int m68ki_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles, const int instrumented)
 {
 	/* eat up any reset cycles */
 	if (RESET_CYCLES) {
@@ -955,6 +1008,7 @@ int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles)
 	/* Set our pool of clock cycles available */
 	SET_CYCLES(num_cycles);
 	m68ki_cpu->m68ki_initial_cycles = num_cycles;
+	m68ki_cpu->fuse_break = 0;
 
 	/* See if interrupts came in */
 	m68ki_check_interrupts(m68ki_cpu);
@@ -975,6 +1029,8 @@ int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles)
 #if M68K_SUPPORT_BUS_ERROR
 			int i;
 #endif
+			const m68ki_opcode_dispatch* op;
+			int cycles;
 			/* Set tracing accodring to T1. (T0 is done inside instruction) */
 			m68ki_trace_t1(); /* auto-disable (see m68kcpu.h) */
 
@@ -983,6 +1039,8 @@ int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles)
 
 			/* Call external hook to peek at CPU */
 			m68ki_instr_hook(REG_PC); /* auto-disable (see m68kcpu.h) */
+			if(instrumented)
+				CALLBACK_INSTR_HOOK(m68ki_cpu, ADDRESS_68K(REG_PC));
 
 			/* Record previous program counter */
 			REG_PPC = REG_PC;
@@ -993,10 +1051,12 @@ int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles)
 				REG_DA_SAVE[i] = REG_DA[i];
 			}
 #endif
-			/* Read an instruction and call its handler */
+			/* Read an instruction and call its handler, the cycles are taken from the same dispatch entry */
 			REG_IR = m68ki_read_imm_16(m68ki_cpu);
-			m68ki_instruction_jump_table[REG_IR](m68ki_cpu);
-			USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
+			op = &m68ki_instruction_dispatch[m68ki_instruction_index[REG_IR]];
+			cycles = op->cycles[CYC_TYPE_INDEX];
+			op->opcode_handler(m68ki_cpu);
+			USE_CYCLES(cycles);
 
 			/* Trace m68k_exception, if necessary */
 			m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
@@ -1013,6 +1073,111 @@ int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles)
 }
 
 
+int m68k_execute(m68ki_cpu_core* m68ki_cpu, int num_cycles)
+{
+	return m68ki_execute(m68ki_cpu, num_cycles, 0);
+}
+
+int m68k_execute_instrumented(m68ki_cpu_core* m68ki_cpu, int num_cycles)
+{
+	return m68ki_execute(m68ki_cpu, num_cycles, 1);
+}
+
+static inline int m68ki_execute_instruction(m68ki_cpu_core* m68ki_cpu, const int instrumented)
+{
+#if M68K_SUPPORT_BUS_ERROR
+	return m68ki_execute(m68ki_cpu, 1, instrumented);
+#else
+	const m68ki_opcode_dispatch* op;
+	uint ir;
+	int cycles;
+
+	/* eat up any reset cycles */
+	if (RESET_CYCLES) {
+	    int rc = RESET_CYCLES;
+	    RESET_CYCLES = 0;
+	    if (rc >= 1)
+		return rc;
+	}
+
+	SET_CYCLES(1);
+	m68ki_cpu->m68ki_initial_cycles = 1;
+	m68ki_cpu->fuse_break = 0;
+
+	m68ki_check_interrupts(m68ki_cpu);
+
+	if(!CPU_STOPPED)
+	{
+		m68ki_set_address_error_trap(); /* auto-disable (see m68kcpu.h) */
+
+		m68ki_trace_t1(); /* auto-disable (see m68kcpu.h) */
+		m68ki_use_data_space(); /* auto-disable (see m68kcpu.h) */
+		m68ki_instr_hook(REG_PC); /* auto-disable (see m68kcpu.h) */
+		if(instrumented)
+			CALLBACK_INSTR_HOOK(m68ki_cpu, ADDRESS_68K(REG_PC));
+
+		REG_PPC = REG_PC;
+
+		/* Keep opcode and cycle count in locals so they do not need to be reloaded after the handler returned */
+		ir = m68ki_read_imm_16(m68ki_cpu);
+		REG_IR = ir;
+		op = &m68ki_instruction_dispatch[m68ki_instruction_index[ir]];
+		cycles = op->cycles[CYC_TYPE_INDEX];
+		op->opcode_handler(m68ki_cpu);
+		USE_CYCLES(cycles);
+
+		m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
+
+		if(m68ki_cpu->fuse_first && (m68ki_cpu->fuse_first[ir >> 3] & (1 << (ir & 7))) && !CPU_STOPPED &&
+			!m68ki_cpu->fuse_break && !m68ki_cpu->nmi_pending && CPU_INT_LEVEL <= FLAG_INT_MASK)
+		{
+			const uint offset = ADDRESS_68K(REG_PC) - m68ki_cpu->code_base;
+
+			if(offset < m68ki_cpu->code_size && m68ki_cpu->code_size - offset >= 2)
+			{
+				const unsigned char* p = m68ki_cpu->code_mem + offset;
+
+				ir = (p[0] << 8) | p[1];
+
+				if(m68k_is_fusable_branch(ir))
+				{
+					m68ki_trace_t1(); /* auto-disable (see m68kcpu.h) */
+					if(instrumented)
+						CALLBACK_INSTR_HOOK(m68ki_cpu, ADDRESS_68K(REG_PC));
+
+					REG_PPC = REG_PC;
+					REG_PC += 2;
+					REG_IR = ir;
+					op = &m68ki_instruction_dispatch[m68ki_instruction_index[ir]];
+					cycles = op->cycles[CYC_TYPE_INDEX];
+					op->opcode_handler(m68ki_cpu);
+					USE_CYCLES(cycles);
+
+					m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
+				}
+			}
+		}
+
+		REG_PPC = REG_PC;
+	}
+	else
+		SET_CYCLES(0);
+
+	return 1 - GET_CYCLES();
+#endif
+}
+
+int m68k_execute_instruction(m68ki_cpu_core* m68ki_cpu)
+{
+	return m68ki_execute_instruction(m68ki_cpu, 0);
+}
+
+int m68k_execute_instruction_instrumented(m68ki_cpu_core* m68ki_cpu)
+{
+	return m68ki_execute_instruction(m68ki_cpu, 1);
+}
+
+
 int m68k_cycles_run(m68ki_cpu_core* m68ki_cpu)
 {
 	return m68ki_cpu->m68ki_initial_cycles - GET_CYCLES();
@@ -38,6 +38,7 @@ extern "C" {
 #endif
 
 #include "m68k.h"
+#include "m68kops.h"
 
 #include <limits.h>
 
@@ -325,7 +326,11 @@ typedef uint32 uint64;
 /* ------------------------------ CPU Access ------------------------------ */
 
 /* Access the CPU registers */
+#if M68K_SPECIALIZE_020
+#define CPU_TYPE         CPU_TYPE_020
+#else
 #define CPU_TYPE         m68ki_cpu->cpu_type
+#endif
 
 #define REG_DA           m68ki_cpu->dar /* easy access to data and address regs */
 #define REG_DA_SAVE           m68ki_cpu->dar_save
@@ -370,7 +375,12 @@ typedef uint32 uint64;
 #define CPU_INSTR_MODE   m68ki_cpu->instr_mode
 #define CPU_RUN_MODE     m68ki_cpu->run_mode
 
-#define CYC_INSTRUCTION  m68ki_cpu->cyc_instruction
+#define CYC_INSTRUCTION(ir) (m68ki_instruction_dispatch[m68ki_instruction_index[ir]].cycles[CYC_TYPE_INDEX])
+#if M68K_SPECIALIZE_020
+#define CYC_TYPE_INDEX   2
+#else
+#define CYC_TYPE_INDEX   m68ki_cpu->cyc_type_index
+#endif
 #define CYC_EXCEPTION    m68ki_cpu->cyc_exception
 #define CYC_BCC_NOTAKE_B m68ki_cpu->cyc_bcc_notake_b
 #define CYC_BCC_NOTAKE_W m68ki_cpu->cyc_bcc_notake_w
@@ -558,7 +568,8 @@ typedef uint32 uint64;
 		#define m68ki_pc_changed(A) CALLBACK_PC_CHANGED(ADDRESS_68K(A))
 	#endif
 #else
-	#define m68ki_pc_changed(A)
+	/* enabled at runtime with m68k_set_monitor_pc(), only jumps pay for the check */
+	#define m68ki_pc_changed(A) do { if(m68ki_cpu->monitor_pc) CALLBACK_PC_CHANGED(m68ki_cpu, ADDRESS_68K(A)); } while(0)
 #endif /* M68K_MONITOR_PC */
 
 
@@ -874,7 +885,7 @@ extern jmp_buf m68ki_aerr_trap;
 #define USE_CYCLES(A)    m68ki_cpu->m68ki_remaining_cycles -= (A)
 #define SET_CYCLES(A)    m68ki_cpu->m68ki_remaining_cycles = A
 #define GET_CYCLES()     m68ki_cpu->m68ki_remaining_cycles
-#define USE_ALL_CYCLES() m68ki_cpu->m68ki_remaining_cycles %= CYC_INSTRUCTION[REG_IR]
+#define USE_ALL_CYCLES() m68ki_cpu->m68ki_remaining_cycles %= CYC_INSTRUCTION(REG_IR)
 
 
 
@@ -927,8 +938,6 @@ struct m68ki_cpu_core_
 {
 	uint cpu_type;     /* CPU Type: 68000, 68008, 68010, 68EC020, 68020, 68EC030, 68030, 68EC040, or 68040 */
 	uint dar[16];      /* Data and Address Registers */
-	uint dar_save[16];  /* Saved Data and Address Registers (pushed onto the
-						   stack when a bus error occurs)*/
 	uint ppc;		   /* Previous program counter */
 	uint pc;           /* Program Counter */
 	uint sp[7];        /* User, Interrupt, and Master Stack Pointers */
@@ -938,10 +947,6 @@ struct m68ki_cpu_core_
 	uint cacr;         /* Cache Control Register (m68020, unemulated) */
 	uint caar;         /* Cache Address Register (m68020, unemulated) */
 	uint ir;           /* Instruction Register */
-	floatx80 fpr[8];     /* FPU Data Register (m68030/040) */
-	uint fpiar;        /* FPU Instruction Address Register (m68040) */
-	uint fpsr;         /* FPU Status Register (m68040) */
-	uint fpcr;         /* FPU Control Register (m68040) */
 	uint t1_flag;      /* Trace 1 */
 	uint t0_flag;      /* Trace 0 */
 	uint s_flag;       /* Supervisor */
@@ -954,15 +959,42 @@ struct m68ki_cpu_core_
 	uint int_mask;     /* I0-I2 */
 	uint int_level;    /* State of interrupt pins IPL0-IPL2 -- ASG: changed from ints_pending */
 	uint stopped;      /* Stopped state */
+	uint address_mask; /* Available address pins */
+
+	/* The state up to here and the cycle and code memory state below is touched by nearly every instruction.
+	   It is kept together so that the register and flag updates of a handler hit as few cache lines as possible */
+	uint cyc_type_index; /* column in m68ki_opcode_dispatch::cycles */
+	const uint8* cyc_exception;
+
+	int  m68ki_initial_cycles;
+	int  m68ki_remaining_cycles;                     /* Number of clocks remaining */
+
+	/* Host memory that immediate reads are served from directly, bypassing m68k_read_immediate_xx() */
+	const unsigned char* code_mem;  /* big endian, code_mem[0] is at 68k address code_base */
+	uint code_base;
+	uint code_size;                  /* in bytes, 0 = disabled */
+
+	const unsigned char* fuse_first; /* bitmap of opcodes a following branch is fused with, see m68k_set_fusion_table() */
+	uint fuse_break;                 /* an exception or m68k_break_fusion() since the start of the execute call */
+
+	/* Rarely used state */
+	uint dar_save[16];  /* Saved Data and Address Registers (pushed onto the
+						   stack when a bus error occurs)*/
+	floatx80 fpr[8];     /* FPU Data Register (m68030/040) */
+	uint fpiar;        /* FPU Instruction Address Register (m68040) */
+	uint fpsr;         /* FPU Status Register (m68040) */
+	uint fpcr;         /* FPU Control Register (m68040) */
 	uint pref_addr;    /* Last prefetch address */
 	uint pref_data;    /* Data in the prefetch queue */
-	uint address_mask; /* Available address pins */
 	uint sr_mask;      /* Implemented status register bits */
 	uint instr_mode;   /* Stores whether we are in instruction mode or group 0/1 exception mode */
 	uint run_mode;     /* Stores whether we are processing a reset, bus error, address error, or something else */
 	int    has_pmmu;     /* Indicates if a PMMU available (yes on 030, 040, no on EC030) */
 	int    pmmu_enabled; /* Indicates if the PMMU is enabled */
 	int    fpu_just_reset; /* Indicates the FPU was just reset */
+	int    has_fpu;         /* FPU coprocessor attached to a 68020/68030, see m68k_set_fpu_enabled() */
+	int    fpu_host_double; /* FPU arithmetic is done with host doubles, see m68k_set_fpu_host_double() */
+	int    monitor_pc;      /* Call the pc changed callback on jumps, see m68k_set_monitor_pc() */
 	uint reset_cycles;
 
 	/* Clocks required for instructions / exceptions */
@@ -986,11 +1018,6 @@ struct m68ki_cpu_core_
 	uint mmu_tc;
 	uint16 mmu_sr;
 
-	const uint8* cyc_instruction;
-	const uint8* cyc_exception;
-
-	int  m68ki_initial_cycles;
-	int  m68ki_remaining_cycles;                     /* Number of clocks remaining */
 
 	/* Callbacks to host */
 	int  (*int_ack_callback)(m68ki_cpu_core* m68ki_cpu, int int_line);           /* Interrupt Acknowledge */
@@ -1067,8 +1094,16 @@ static inline uint m68ki_read_imm_16(m68ki_cpu_core* m68ki_cpu)
 	return result;
 }
 #else
+{
+	const uint offset = ADDRESS_68K(REG_PC) - m68ki_cpu->code_base;
 	REG_PC += 2;
+	if(offset < m68ki_cpu->code_size && m68ki_cpu->code_size - offset >= 2)
+	{
+		const unsigned char* p = m68ki_cpu->code_mem + offset;
+		return (p[0] << 8) | p[1];
+	}
 	return m68k_read_immediate_16(m68ki_cpu, ADDRESS_68K(REG_PC-2));
+}
 #endif /* M68K_EMULATE_PREFETCH */
 }
 
@@ -1112,8 +1147,16 @@ static inline uint m68ki_read_imm_32(m68ki_cpu_core* m68ki_cpu)
 #else
 	m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
 	m68ki_check_address_error(REG_PC, MODE_READ, FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
+{
+	const uint offset = ADDRESS_68K(REG_PC) - m68ki_cpu->code_base;
 	REG_PC += 4;
+	if(offset < m68ki_cpu->code_size && m68ki_cpu->code_size - offset >= 4)
+	{
+		const unsigned char* p = m68ki_cpu->code_mem + offset;
+		return ((uint)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	}
 	return m68k_read_immediate_32(m68ki_cpu, ADDRESS_68K(REG_PC-4));
+}
 #endif /* M68K_EMULATE_PREFETCH */
 }
 
@@ -1219,6 +1262,76 @@ static inline void m68ki_write_32_pd_fc(m68ki_cpu_core* m68ki_cpu, uint address,
 }
 #endif
 
+/* Burst transfers, see m68k_read_memory_burst(). Misaligned and translated
+ * accesses are never bursted so that address errors and the PMMU keep working
+ */
+static inline int m68ki_read_burst(m68ki_cpu_core* m68ki_cpu, uint address, uint count, uint size, uint* values)
+{
+#if M68K_EMULATE_PMMU
+	if (PMMU_ENABLED)
+		return 0;
+#endif
+	if(address & 1)
+		return 0;
+	return m68k_read_memory_burst(m68ki_cpu, ADDRESS_68K(address), count, size, values);
+}
+
+static inline int m68ki_write_burst(m68ki_cpu_core* m68ki_cpu, uint address, uint count, uint size, const uint* values)
+{
+#if M68K_EMULATE_PMMU
+	if (PMMU_ENABLED)
+		return 0;
+#endif
+	if(address & 1)
+		return 0;
+	return m68k_write_memory_burst(m68ki_cpu, ADDRESS_68K(address), count, size, values);
+}
+
+/* MOVEM register transfers as one burst. Return the number of registers
+ * transferred and advance *ea, or return 0 if the bus did not take the burst
+ */
+static inline uint m68ki_movem_write_burst(m68ki_cpu_core* m68ki_cpu, uint register_list, uint* ea, uint size, int predecrement)
+{
+	uint values[16];
+	uint count = 0;
+	uint address;
+	uint i;
+
+	/* for -(An) the register list is reversed, bit 0 is A7 */
+	for(i = 0; i < 16; i++)
+		if(register_list & (1 << (predecrement ? 15 - i : i)))
+			values[count++] = size == 2 ? MASK_OUT_ABOVE_16(REG_DA[i]) : REG_DA[i];
+
+	address = predecrement ? *ea - count * size : *ea;
+
+	if(!count || !m68ki_write_burst(m68ki_cpu, address, count, size, values))
+		return 0;
+
+	*ea = predecrement ? address : address + count * size;
+	return count;
+}
+
+static inline uint m68ki_movem_read_burst(m68ki_cpu_core* m68ki_cpu, uint register_list, uint* ea, uint size)
+{
+	uint values[16];
+	uint regs[16];
+	uint count = 0;
+	uint i;
+
+	for(i = 0; i < 16; i++)
+		if(register_list & (1 << i))
+			regs[count++] = i;
+
+	if(!count || !m68ki_read_burst(m68ki_cpu, *ea, count, size, values))
+		return 0;
+
+	for(i = 0; i < count; i++)
+		REG_DA[regs[i]] = size == 2 ? (uint)MAKE_INT_16(MASK_OUT_ABOVE_16(values[i])) : values[i];
+
+	*ea += count * size;
+	return count;
+}
+
 /* --------------------- Effective Address Calculation -------------------- */
 
 /* The program counter relative addressing modes cause operands to be
@@ -1593,6 +1706,8 @@ static inline uint m68ki_init_exception(m68ki_cpu_core* m68ki_cpu)
 	/* Turn off trace flag, clear pending traces */
 	FLAG_T1 = FLAG_T0 = 0;
 	m68ki_clear_trace();
+	/* Do not fuse a branch into the handler */
+	m68ki_cpu->fuse_break = 1;
 	/* Enter supervisor mode */
 	m68ki_set_s_flag(m68ki_cpu, SFLAG_SET);
 
@@ -1617,6 +1732,15 @@ static inline void m68ki_stack_frame_0000(m68ki_cpu_core* m68ki_cpu, uint pc, ui
 		m68ki_stack_frame_3word(m68ki_cpu, pc, sr);
 		return;
 	}
+	{
+		const uint frame[4] = {MASK_OUT_ABOVE_16(sr), pc >> 16, MASK_OUT_ABOVE_16(pc), vector<<2};
+		const uint sp = MASK_OUT_ABOVE_32(REG_SP - 8);
+		if(m68ki_write_burst(m68ki_cpu, sp, 4, 2, frame))
+		{
+			REG_SP = sp;
+			return;
+		}
+	}
 	m68ki_push_16(m68ki_cpu, vector<<2);
 	m68ki_push_32(m68ki_cpu, pc);
 	m68ki_push_16(m68ki_cpu, sr);
@@ -1637,6 +1761,15 @@ static inline void m68ki_stack_frame_0001(m68ki_cpu_core* m68ki_cpu, uint pc, ui
  */
 static inline void m68ki_stack_frame_0010(m68ki_cpu_core* m68ki_cpu, uint sr, uint vector)
 {
+	{
+		const uint frame[6] = {MASK_OUT_ABOVE_16(sr), REG_PC >> 16, MASK_OUT_ABOVE_16(REG_PC), 0x2000 | (vector<<2), REG_PPC >> 16, MASK_OUT_ABOVE_16(REG_PPC)};
+		const uint sp = MASK_OUT_ABOVE_32(REG_SP - 12);
+		if(m68ki_write_burst(m68ki_cpu, sp, 6, 2, frame))
+		{
+			REG_SP = sp;
+			return;
+		}
+	}
 	m68ki_push_32(m68ki_cpu, REG_PPC);
 	m68ki_push_16(m68ki_cpu, 0x2000 | (vector<<2));
 	m68ki_push_32(m68ki_cpu, REG_PC);
@@ -1847,7 +1980,7 @@ static inline void m68ki_exception_trap(m68ki_cpu_core* m68ki_cpu, uint vector)
 	m68ki_jump_vector(m68ki_cpu, vector);
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[vector] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[vector] - CYC_INSTRUCTION(REG_IR));
 }
 
 /* Trap#n stacks a 0 frame but behaves like group2 otherwise */
@@ -1858,7 +1991,7 @@ static inline void m68ki_exception_trapN(m68ki_cpu_core* m68ki_cpu, uint vector)
 	m68ki_jump_vector(m68ki_cpu, vector);
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[vector] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[vector] - CYC_INSTRUCTION(REG_IR));
 }
 
 /* Exception for trace mode */
@@ -1904,7 +2037,7 @@ static inline void m68ki_exception_privilege_violation(m68ki_cpu_core* m68ki_cpu
 	m68ki_jump_vector(m68ki_cpu, EXCEPTION_PRIVILEGE_VIOLATION);
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_PRIVILEGE_VIOLATION] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_PRIVILEGE_VIOLATION] - CYC_INSTRUCTION(REG_IR));
 }
 
 extern jmp_buf m68ki_bus_error_jmp_buf;
@@ -1929,7 +2062,7 @@ static inline void m68ki_exception_bus_error(m68ki_cpu_core* m68ki_cpu)
 	CPU_RUN_MODE = RUN_MODE_BERR_AERR_RESET_WSF;
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_BUS_ERROR] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_BUS_ERROR] - CYC_INSTRUCTION(REG_IR));
 
 	for (i = 15; i >= 0; i--){
 		REG_DA[i] = REG_DA_SAVE[i];
@@ -1964,7 +2097,7 @@ static inline void m68ki_exception_1010(m68ki_cpu_core* m68ki_cpu)
 	m68ki_jump_vector(m68ki_cpu, EXCEPTION_1010);
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_1010] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_1010] - CYC_INSTRUCTION(REG_IR));
 }
 
 /* Exception for F-Line instructions */
@@ -1983,7 +2116,7 @@ static inline void m68ki_exception_1111(m68ki_cpu_core* m68ki_cpu)
 	m68ki_jump_vector(m68ki_cpu, EXCEPTION_1111);
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_1111] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_1111] - CYC_INSTRUCTION(REG_IR));
 }
 
 #if M68K_ILLG_HAS_CALLBACK == OPT_SPECIFY_HANDLER
@@ -2014,7 +2147,7 @@ static inline void m68ki_exception_illegal(m68ki_cpu_core* m68ki_cpu)
 	m68ki_jump_vector(m68ki_cpu, EXCEPTION_ILLEGAL_INSTRUCTION);
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_ILLEGAL_INSTRUCTION] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_ILLEGAL_INSTRUCTION] - CYC_INSTRUCTION(REG_IR));
 }
 
 /* Exception for format errror in RTE */
@@ -2025,7 +2158,7 @@ static inline void m68ki_exception_format_error(m68ki_cpu_core* m68ki_cpu)
 	m68ki_jump_vector(m68ki_cpu, EXCEPTION_FORMAT_ERROR);
 
 	/* Use up some clock cycles and undo the instruction's cycles */
-	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_FORMAT_ERROR] - CYC_INSTRUCTION[REG_IR]);
+	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_FORMAT_ERROR] - CYC_INSTRUCTION(REG_IR));
 }
 
 /* Exception for address error */
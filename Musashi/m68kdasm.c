@@ -211,17 +211,26 @@ static void (*g_instruction_table[0x10000])(void);
 /* Flag if disassembler initialized */
 static int  g_initialized = 0;
 
+/* Disassembler state is kept per thread to be able to disassemble disjoint
+ * ranges in parallel. The opcode table is shared, it is built on first use.
+ */
+#if defined(_MSC_VER)
+#define DASM_THREAD_LOCAL __declspec(thread)
+#else
+#define DASM_THREAD_LOCAL __thread
+#endif
+
 /* Address mask to simulate address lines */
-static unsigned int g_address_mask = 0xffffffff;
+static DASM_THREAD_LOCAL unsigned int g_address_mask = 0xffffffff;
 
-static char g_dasm_str[100]; /* string to hold disassembly */
-static char g_helper_str[100]; /* string to hold helpful info */
-static uint g_cpu_pc;        /* program counter */
-static uint g_cpu_ir;        /* instruction register */
-static uint g_cpu_type;
-static uint g_opcode_type;
-static const unsigned char* g_rawop;
-static uint g_rawbasepc;
+static DASM_THREAD_LOCAL char g_dasm_str[100]; /* string to hold disassembly */
+static DASM_THREAD_LOCAL char g_helper_str[100]; /* string to hold helpful info */
+static DASM_THREAD_LOCAL uint g_cpu_pc;        /* program counter */
+static DASM_THREAD_LOCAL uint g_cpu_ir;        /* instruction register */
+static DASM_THREAD_LOCAL uint g_cpu_type;
+static DASM_THREAD_LOCAL uint g_opcode_type;
+static DASM_THREAD_LOCAL const unsigned char* g_rawop;
+static DASM_THREAD_LOCAL uint g_rawbasepc;
 
 /* used by ops like asr, ror, addq, etc */
 static const uint g_3bit_qdata_table[8] = {8, 1, 2, 3, 4, 5, 6, 7};
@@ -354,7 +363,7 @@ static int make_int_32(int value)
 /* Get string representation of hex values */
 static char* make_signed_hex_str_8(uint val)
 {
-	static char str[20];
+	static DASM_THREAD_LOCAL char str[20];
 
 	val &= 0xff;
 
@@ -370,7 +379,7 @@ static char* make_signed_hex_str_8(uint val)
 
 static char* make_signed_hex_str_16(uint val)
 {
-	static char str[20];
+	static DASM_THREAD_LOCAL char str[20];
 
 	val &= 0xffff;
 
@@ -386,7 +395,7 @@ static char* make_signed_hex_str_16(uint val)
 
 static char* make_signed_hex_str_32(uint val)
 {
-	static char str[20];
+	static DASM_THREAD_LOCAL char str[20];
 
 	val &= 0xffffffff;
 
@@ -404,7 +413,7 @@ static char* make_signed_hex_str_32(uint val)
 /* make string of immediate value */
 static char* get_imm_str_s(uint size)
 {
-	static char str[15];
+	static DASM_THREAD_LOCAL char str[15];
 	if(size == 0)
 		sprintf(str, "#%s", make_signed_hex_str_8(read_imm_8()));
 	else if(size == 1)
@@ -416,7 +425,7 @@ static char* get_imm_str_s(uint size)
 
 static char* get_imm_str_u(uint size)
 {
-	static char str[15];
+	static DASM_THREAD_LOCAL char str[15];
 	if(size == 0)
 		sprintf(str, "#$%x", read_imm_8() & 0xff);
 	else if(size == 1)
@@ -429,9 +438,9 @@ static char* get_imm_str_u(uint size)
 /* Make string of effective address mode */
 static char* get_ea_mode_str(uint instruction, uint size)
 {
-	static char b1[64];
-	static char b2[64];
-	static char* mode = b2;
+	static DASM_THREAD_LOCAL char b1[64];
+	static DASM_THREAD_LOCAL char b2[64];
+	static DASM_THREAD_LOCAL char* mode = NULL;
 	uint extension;
 	uint base;
 	uint outer;
@@ -3773,7 +3782,7 @@ unsigned int m68k_disassemble(char* str_buff, unsigned int pc, unsigned int cpu_
 
 char* m68ki_disassemble_quick(unsigned int pc, unsigned int cpu_type)
 {
-	static char buff[100];
+	static DASM_THREAD_LOCAL char buff[100];
 	buff[0] = 0;
 	m68k_disassemble(buff, pc, cpu_type);
 	return buff;
@@ -20,7 +20,12 @@ static void fatalerror(const char *format, ...) {
 #define DOUBLE_EXPONENT					(unsigned long long)(0x7ff0000000000000)
 #define DOUBLE_MANTISSA					(unsigned long long)(0x000fffffffffffff)
 
-extern char floatx80_is_nan( floatx80 a );
+#ifdef __cplusplus
+extern "C"
+#else
+extern
+#endif
+char floatx80_is_nan( floatx80 a );
 
 // masks for packed dwords, positive k-factor
 static uint32 pkmask2[18] =
@@ -59,6 +64,24 @@ static inline floatx80 double_to_fx80(double in)
 	return float64_to_floatx80(*d);
 }
 
+/* Arithmetic of the host double mode, see m68k_set_fpu_host_double() */
+static inline floatx80 fpu_host_double_op(int opmode, floatx80 dst, floatx80 src)
+{
+	const double a = fx80_to_double(dst);
+	const double b = fx80_to_double(src);
+
+	switch (opmode)
+	{
+		case 0x04:	return double_to_fx80(sqrt(b));
+		case 0x20:
+		case 0x60:	return double_to_fx80(a / b);
+		case 0x22:	return double_to_fx80(a + b);
+		case 0x23:
+		case 0x63:	return double_to_fx80(a * b);
+		default:	return double_to_fx80(a - b);	/* FSUB, FCMP */
+	}
+}
+
 static inline floatx80 load_extended_float80(m68ki_cpu_core* m68ki_cpu, uint32 ea)
 {
 	uint32 d1,d2;
@@ -535,6 +558,30 @@ static uint32 READ_EA_32(m68ki_cpu_core* m68ki_cpu, int ea)
 	return 0;
 }
 
+/* 64 bit operands are transferred as one burst if the bus takes it */
+static uint64 m68ki_read_64(m68ki_cpu_core* m68ki_cpu, uint32 ea)
+{
+	uint values[2];
+
+	if(!m68ki_read_burst(m68ki_cpu, ea, 2, 4, values))
+	{
+		values[0] = m68ki_read_32(ea+0);
+		values[1] = m68ki_read_32(ea+4);
+	}
+	return (uint64)(values[0]) << 32 | (uint64)(values[1]);
+}
+
+static void m68ki_write_64(m68ki_cpu_core* m68ki_cpu, uint32 ea, uint64 data)
+{
+	const uint values[2] = {(uint32)(data >> 32), (uint32)(data)};
+
+	if(!m68ki_write_burst(m68ki_cpu, ea, 2, 4, values))
+	{
+		m68ki_write_32(ea+0, values[0]);
+		m68ki_write_32(ea+4, values[1]);
+	}
+}
+
 static uint64 READ_EA_64(m68ki_cpu_core* m68ki_cpu, int ea)
 {
 	int mode = (ea >> 3) & 0x7;
@@ -546,24 +593,18 @@ static uint64 READ_EA_64(m68ki_cpu_core* m68ki_cpu, int ea)
 		case 2:		// (An)
 		{
 			uint32 ea = REG_A[reg];
-			h1 = m68ki_read_32(ea+0);
-			h2 = m68ki_read_32(ea+4);
-			return  (uint64)(h1) << 32 | (uint64)(h2);
+			return m68ki_read_64(m68ki_cpu, ea);
 		}
 		case 3:		// (An)+
 		{
 			uint32 ea = REG_A[reg];
 			REG_A[reg] += 8;
-			h1 = m68ki_read_32(ea+0);
-			h2 = m68ki_read_32(ea+4);
-			return  (uint64)(h1) << 32 | (uint64)(h2);
+			return m68ki_read_64(m68ki_cpu, ea);
 		}
 		case 5:		// (d16, An)
 		{
 			uint32 ea = EA_AY_DI_32();
-			h1 = m68ki_read_32(ea+0);
-			h2 = m68ki_read_32(ea+4);
-			return  (uint64)(h1) << 32 | (uint64)(h2);
+			return m68ki_read_64(m68ki_cpu, ea);
 		}
 		case 7:
 		{
@@ -578,9 +619,7 @@ static uint64 READ_EA_64(m68ki_cpu_core* m68ki_cpu, int ea)
 				case 2:		// (d16, PC)
 				{
 					uint32 ea = EA_PCDI_32();
-					h1 = m68ki_read_32(ea+0);
-					h2 = m68ki_read_32(ea+4);
-					return  (uint64)(h1) << 32 | (uint64)(h2);
+					return m68ki_read_64(m68ki_cpu, ea);
 				}
 				default:	fatalerror("M68kFPU: READ_EA_64: unhandled mode %d, reg %d at %08X\n", mode, reg, REG_PC);
 			}
@@ -922,8 +961,7 @@ static void WRITE_EA_64(m68ki_cpu_core* m68ki_cpu, int ea, uint64 data)
 		case 2:		// (An)
 		{
 			uint32 ea = REG_A[reg];
-			m68ki_write_32(ea, (uint32)(data >> 32));
-			m68ki_write_32(ea+4, (uint32)(data));
+			m68ki_write_64(m68ki_cpu, ea, data);
 			break;
 		}
 		case 4:		// -(An)
@@ -931,15 +969,13 @@ static void WRITE_EA_64(m68ki_cpu_core* m68ki_cpu, int ea, uint64 data)
 			uint32 ea;
 			REG_A[reg] -= 8;
 			ea = REG_A[reg];
-			m68ki_write_32(ea+0, (uint32)(data >> 32));
-			m68ki_write_32(ea+4, (uint32)(data));
+			m68ki_write_64(m68ki_cpu, ea, data);
 			break;
 		}
 		case 5:		// (d16, An)
 		{
 			uint32 ea = EA_AY_DI_32();
-			m68ki_write_32(ea+0, (uint32)(data >> 32));
-			m68ki_write_32(ea+4, (uint32)(data));
+			m68ki_write_64(m68ki_cpu, ea, data);
 			break;
 		}
 		default:	fatalerror("M68kFPU: WRITE_EA_64: unhandled mode %d, reg %d, data %08X%08X at %08X\n", mode, reg, (uint32)(data >> 32), (uint32)(data), REG_PC);
@@ -1206,7 +1242,7 @@ static void fpgen_rm_reg(m68ki_cpu_core* m68ki_cpu, uint16 w2)
 		}
 		case 0x04:		// FSQRT
 		{
-			REG_FP[dst] = floatx80_sqrt(source);
+			REG_FP[dst] = m68ki_cpu->fpu_host_double ? fpu_host_double_op(opmode, REG_FP[dst], source) : floatx80_sqrt(source);
 			SET_CONDITION_CODES(m68ki_cpu, REG_FP[dst]);
 			USE_CYCLES(109);
 			break;
@@ -1240,14 +1276,14 @@ static void fpgen_rm_reg(m68ki_cpu_core* m68ki_cpu, uint16 w2)
   	    case 0x60:		// FSDIVS (JFF) (source has already been converted to floatx80)
 		case 0x20:		// FDIV
 		{
-			REG_FP[dst] = floatx80_div(REG_FP[dst], source);
+			REG_FP[dst] = m68ki_cpu->fpu_host_double ? fpu_host_double_op(opmode, REG_FP[dst], source) : floatx80_div(REG_FP[dst], source);
 		    SET_CONDITION_CODES(m68ki_cpu, REG_FP[dst]); // JFF
 			USE_CYCLES(43);
 			break;
 		}
 		case 0x22:		// FADD
 		{
-			REG_FP[dst] = floatx80_add(REG_FP[dst], source);
+			REG_FP[dst] = m68ki_cpu->fpu_host_double ? fpu_host_double_op(opmode, REG_FP[dst], source) : floatx80_add(REG_FP[dst], source);
 			SET_CONDITION_CODES(m68ki_cpu, REG_FP[dst]);
 			USE_CYCLES(9);
 			break;
@@ -1255,7 +1291,7 @@ static void fpgen_rm_reg(m68ki_cpu_core* m68ki_cpu, uint16 w2)
    		case 0x63:		// FSMULS (JFF) (source has already been converted to floatx80)
 		case 0x23:		// FMUL
 		{
-			REG_FP[dst] = floatx80_mul(REG_FP[dst], source);
+			REG_FP[dst] = m68ki_cpu->fpu_host_double ? fpu_host_double_op(opmode, REG_FP[dst], source) : floatx80_mul(REG_FP[dst], source);
 			SET_CONDITION_CODES(m68ki_cpu, REG_FP[dst]);
 			USE_CYCLES(11);
 			break;
@@ -1269,7 +1305,7 @@ static void fpgen_rm_reg(m68ki_cpu_core* m68ki_cpu, uint16 w2)
 		}
 		case 0x28:		// FSUB
 		{
-			REG_FP[dst] = floatx80_sub(REG_FP[dst], source);
+			REG_FP[dst] = m68ki_cpu->fpu_host_double ? fpu_host_double_op(opmode, REG_FP[dst], source) : floatx80_sub(REG_FP[dst], source);
 			SET_CONDITION_CODES(m68ki_cpu, REG_FP[dst]);
 			USE_CYCLES(9);
 			break;
@@ -1277,7 +1313,7 @@ static void fpgen_rm_reg(m68ki_cpu_core* m68ki_cpu, uint16 w2)
 		case 0x38:		// FCMP
 		{
 			floatx80 res;
-			res = floatx80_sub(REG_FP[dst], source);
+			res = m68ki_cpu->fpu_host_double ? fpu_host_double_op(opmode, REG_FP[dst], source) : floatx80_sub(REG_FP[dst], source);
 			SET_CONDITION_CODES(m68ki_cpu, res);
 			USE_CYCLES(7);
 			break;
@@ -4,6 +4,7 @@ extern void m68040_fpu_op0(m68ki_cpu_core* m68ki_cpu);
 extern void m68040_fpu_op1(m68ki_cpu_core* m68ki_cpu);
 
 #include <stdio.h>
+#include <stdlib.h>
 
 /* ======================================================================== */
 /* ========================= INSTRUCTION HANDLERS ========================= */
@@ -24,7 +25,7 @@ static void m68k_op_1111(m68ki_cpu_core* m68ki_cpu)
 
 static void m68k_op_040fpu0_32(m68ki_cpu_core* m68ki_cpu)
 {
-	if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
+	if(CPU_TYPE_IS_040_PLUS(CPU_TYPE) || m68ki_cpu->has_fpu)
 	{
 		m68040_fpu_op0(m68ki_cpu);
 		return;
@@ -35,7 +36,7 @@ static void m68k_op_040fpu0_32(m68ki_cpu_core* m68ki_cpu)
 
 static void m68k_op_040fpu1_32(m68ki_cpu_core* m68ki_cpu)
 {
-	if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
+	if(CPU_TYPE_IS_040_PLUS(CPU_TYPE) || m68ki_cpu->has_fpu)
 	{
 		m68040_fpu_op1(m68ki_cpu);
 		return;
@@ -22555,15 +22556,18 @@ static void m68k_op_movem_16_re_pd(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = AY;
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 2, 1);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			ea -= 2;
-			m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[15-i]));
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				ea -= 2;
+				m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[15-i]));
+				count++;
+			}
+	}
 	AY = ea;
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
@@ -22575,15 +22579,18 @@ static void m68k_op_movem_16_re_ai(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_AI_16();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 2, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22594,15 +22601,18 @@ static void m68k_op_movem_16_re_di(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_DI_16();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 2, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22613,15 +22623,18 @@ static void m68k_op_movem_16_re_ix(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_IX_16();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 2, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22632,15 +22645,18 @@ static void m68k_op_movem_16_re_aw(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AW_16();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 2, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22651,15 +22667,18 @@ static void m68k_op_movem_16_re_al(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AL_16();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 2, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_16(ea, MASK_OUT_ABOVE_16(REG_DA[i]));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22670,16 +22689,19 @@ static void m68k_op_movem_32_re_pd(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = AY;
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 4, 1);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			ea -= 4;
-			m68ki_write_16(ea+2, REG_DA[15-i] & 0xFFFF );
-			m68ki_write_16(ea, (REG_DA[15-i] >> 16) & 0xFFFF );
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				ea -= 4;
+				m68ki_write_16(ea+2, REG_DA[15-i] & 0xFFFF );
+				m68ki_write_16(ea, (REG_DA[15-i] >> 16) & 0xFFFF );
+				count++;
+			}
+	}
 	AY = ea;
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
@@ -22691,15 +22713,18 @@ static void m68k_op_movem_32_re_ai(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_AI_32();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 4, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_32(ea, REG_DA[i]);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_32(ea, REG_DA[i]);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -22710,15 +22735,18 @@ static void m68k_op_movem_32_re_di(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_DI_32();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 4, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_32(ea, REG_DA[i]);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_32(ea, REG_DA[i]);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -22729,15 +22757,18 @@ static void m68k_op_movem_32_re_ix(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_IX_32();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 4, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_32(ea, REG_DA[i]);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_32(ea, REG_DA[i]);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -22748,15 +22779,18 @@ static void m68k_op_movem_32_re_aw(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AW_32();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 4, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_32(ea, REG_DA[i]);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_32(ea, REG_DA[i]);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -22767,15 +22801,18 @@ static void m68k_op_movem_32_re_al(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AL_32();
-	uint count = 0;
+	uint count = m68ki_movem_write_burst(m68ki_cpu, register_list, &ea, 4, 0);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			m68ki_write_32(ea, REG_DA[i]);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				m68ki_write_32(ea, REG_DA[i]);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -22786,15 +22823,18 @@ static void m68k_op_movem_16_er_pi(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = AY;
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 2);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
+				ea += 2;
+				count++;
+			}
+	}
 	AY = ea;
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
@@ -22844,15 +22884,18 @@ static void m68k_op_movem_16_er_ai(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_AI_16();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 2);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22863,15 +22906,18 @@ static void m68k_op_movem_16_er_di(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_DI_16();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 2);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22882,15 +22928,18 @@ static void m68k_op_movem_16_er_ix(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_IX_16();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 2);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22901,15 +22950,18 @@ static void m68k_op_movem_16_er_aw(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AW_16();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 2);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22920,15 +22972,18 @@ static void m68k_op_movem_16_er_al(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AL_16();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 2);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
-			ea += 2;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = MAKE_INT_16(MASK_OUT_ABOVE_16(m68ki_read_16(ea)));
+				ea += 2;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_W);
 }
@@ -22939,15 +22994,18 @@ static void m68k_op_movem_32_er_pi(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = AY;
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 4);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = m68ki_read_32(ea);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = m68ki_read_32(ea);
+				ea += 4;
+				count++;
+			}
+	}
 	AY = ea;
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
@@ -22997,15 +23055,18 @@ static void m68k_op_movem_32_er_ai(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_AI_32();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 4);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = m68ki_read_32(ea);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = m68ki_read_32(ea);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -23016,15 +23077,18 @@ static void m68k_op_movem_32_er_di(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_DI_32();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 4);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = m68ki_read_32(ea);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = m68ki_read_32(ea);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -23035,15 +23099,18 @@ static void m68k_op_movem_32_er_ix(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AY_IX_32();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 4);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = m68ki_read_32(ea);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = m68ki_read_32(ea);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -23054,15 +23121,18 @@ static void m68k_op_movem_32_er_aw(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AW_32();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 4);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = m68ki_read_32(ea);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = m68ki_read_32(ea);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -23073,15 +23143,18 @@ static void m68k_op_movem_32_er_al(m68ki_cpu_core* m68ki_cpu)
 	uint i = 0;
 	uint register_list = OPER_I_16();
 	uint ea = EA_AL_32();
-	uint count = 0;
+	uint count = m68ki_movem_read_burst(m68ki_cpu, register_list, &ea, 4);
 
-	for(; i < 16; i++)
-		if(register_list & (1 << i))
-		{
-			REG_DA[i] = m68ki_read_32(ea);
-			ea += 4;
-			count++;
-		}
+	if(!count)
+	{
+		for(; i < 16; i++)
+			if(register_list & (1 << i))
+			{
+				REG_DA[i] = m68ki_read_32(ea);
+				ea += 4;
+				count++;
+			}
+	}
 
 	USE_CYCLES(count<<CYC_MOVEM_L);
 }
@@ -30819,8 +30892,8 @@ static void m68k_op_stop(m68ki_cpu_core* m68ki_cpu)
 		m68ki_trace_t0();			   /* auto-disable (see m68kcpu.h) */
 		CPU_STOPPED |= STOP_LEVEL_STOP;
 		m68ki_set_sr(m68ki_cpu, new_sr);
-		if(m68ki_cpu->m68ki_remaining_cycles >= CYC_INSTRUCTION[REG_IR])
-			m68ki_cpu->m68ki_remaining_cycles = CYC_INSTRUCTION[REG_IR];
+		if(m68ki_cpu->m68ki_remaining_cycles >= CYC_INSTRUCTION(REG_IR))
+			m68ki_cpu->m68ki_remaining_cycles = CYC_INSTRUCTION(REG_IR);
 		else
 			USE_ALL_CYCLES();
 		return;
@@ -34579,8 +34652,8 @@ static void m68k_op_tblu(m68ki_cpu_core* m68ki_cpu)
 
 #define NUM_CPU_TYPES 4
 
-void  (*m68ki_instruction_jump_table[0x10000])(m68ki_cpu_core* m68ki_cpu); /* opcode handler jump table */
-unsigned char m68ki_cycles[NUM_CPU_TYPES][0x10000]; /* Cycles used by CPU type */
+unsigned short m68ki_instruction_index[0x10000]; /* opcode => index into m68ki_instruction_dispatch */
+m68ki_opcode_dispatch m68ki_instruction_dispatch[M68KI_MAX_DISPATCH]; /* handler and cycles per CPU type */
 
 /* This is used to generate the opcode handler jump table */
 typedef struct
@@ -36569,118 +36642,128 @@ static const opcode_handler_struct m68k_opcode_handler_table[] =
 };
 
 
+static unsigned int m68ki_dispatch_count;
+
+/* Adds a dispatch entry and returns its index */
+static unsigned short m68ki_add_dispatch(void (*handler)(m68ki_cpu_core*), const unsigned char* cycles, int cycle_cost)
+{
+	m68ki_opcode_dispatch* d;
+	int k;
+
+	if(m68ki_dispatch_count >= M68KI_MAX_DISPATCH)
+	{
+		fprintf(stderr, "m68ki_add_dispatch: more than %d handler / cycle combinations, increase M68KI_MAX_DISPATCH\n", M68KI_MAX_DISPATCH);
+		abort();
+	}
+
+	d = &m68ki_instruction_dispatch[m68ki_dispatch_count];
+	d->opcode_handler = handler;
+	for(k=0;k<NUM_CPU_TYPES;k++)
+		d->cycles[k] = cycles[k];
+
+	// On the 68000 and 68010 shift distance affect execution time, on the 68020 it does not
+	d->cycles[0] += cycle_cost;
+	d->cycles[1] += cycle_cost;
+
+	return (unsigned short)m68ki_dispatch_count++;
+}
+
+static void m68ki_set_opcode(unsigned int instr, unsigned short index)
+{
+	m68ki_instruction_index[instr] = index;
+}
+
 /* Build the opcode handler jump table */
 void m68ki_build_opcode_table(void)
 {
+	static const unsigned char illegal_cycles[NUM_CPU_TYPES] = {0};
 	const opcode_handler_struct *ostruct;
+	unsigned short index;
+	int is_shift;
 	int cycle_cost;
 	int instr;
 	int i;
 	int j;
-	int k;
 
+	m68ki_dispatch_count = 0;
+
+	/* default to illegal */
+	index = m68ki_add_dispatch(m68k_op_illegal, illegal_cycles, 0);
 	for(i = 0; i < 0x10000; i++)
-	{
-		/* default to illegal */
-		m68ki_instruction_jump_table[i] = m68k_op_illegal;
-		for(k=0;k<NUM_CPU_TYPES;k++)
-			m68ki_cycles[k][i] = 0;
-	}
+		m68ki_set_opcode(i, index);
 
 	ostruct = m68k_opcode_handler_table;
 	while(ostruct->mask != 0xff00)
 	{
+		index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
 		for(i = 0;i < 0x10000;i++)
 		{
 			if((i & ostruct->mask) == ostruct->match)
-			{
-				m68ki_instruction_jump_table[i] = ostruct->opcode_handler;
-				for(k=0;k<NUM_CPU_TYPES;k++)
-					m68ki_cycles[k][i] = ostruct->cycles[k];
-			}
+				m68ki_set_opcode(i, index);
 		}
 		ostruct++;
 	}
 	while(ostruct->mask == 0xff00)
 	{
+		index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
 		for(i = 0;i <= 0xff;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | i] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | i] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | i, index);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xf1f8)
 	{
+		// For all shift operations with known shift distance (encoded in instruction word)
+		// add the cycle cost of shifting; 2 times the shift distance
+		is_shift = (ostruct->match & 0xf000) == 0xe000 && (!(ostruct->match & 0x20));
+		if(!is_shift)
+			index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
 		for(i = 0;i < 8;i++)
 		{
+			if(is_shift)
+			{
+				cycle_cost = ((((i-1)&7)+1)<<1);
+				index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, cycle_cost);
+			}
 			for(j = 0;j < 8;j++)
 			{
 				instr = ostruct->match | (i << 9) | j;
-				m68ki_instruction_jump_table[instr] = ostruct->opcode_handler;
-				for(k=0;k<NUM_CPU_TYPES;k++)
-					m68ki_cycles[k][instr] = ostruct->cycles[k];
-				// For all shift operations with known shift distance (encoded in instruction word)
-				if((instr & 0xf000) == 0xe000 && (!(instr & 0x20)))
-				{
-					// On the 68000 and 68010 shift distance affect execution time.
-					// Add the cycle cost of shifting; 2 times the shift distance
-					cycle_cost = ((((i-1)&7)+1)<<1);
-					m68ki_cycles[0][instr] += cycle_cost;
-					m68ki_cycles[1][instr] += cycle_cost;
-					// On the 68020 shift distance does not affect execution time
-					m68ki_cycles[2][instr] += 0;
-				}
+				m68ki_set_opcode(instr, index);
 			}
 		}
 		ostruct++;
 	}
 	while(ostruct->mask == 0xfff0)
 	{
+		index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
 		for(i = 0;i <= 0x0f;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | i] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | i] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | i, index);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xf1ff)
 	{
+		index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
 		for(i = 0;i <= 0x07;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | (i << 9)] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | (i << 9)] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | (i << 9), index);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xffc0)
 	{
+		index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
 		for(i = 0;i < 0x3f; i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | i] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | i] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | i, index);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xfff8)
 	{
+		index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
 		for(i = 0;i <= 0x07;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | i] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | i] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | i, index);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xffff)
 	{
-		m68ki_instruction_jump_table[ostruct->match] = ostruct->opcode_handler;
-		for(k=0;k<NUM_CPU_TYPES;k++)
-			m68ki_cycles[k][ostruct->match] = ostruct->cycles[k];
+		index = m68ki_add_dispatch(ostruct->opcode_handler, ostruct->cycles, 0);
+		m68ki_set_opcode(ostruct->match, index);
 		ostruct++;
 	}
 }
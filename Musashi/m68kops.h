@@ -10,8 +10,20 @@ typedef struct m68ki_cpu_core_ m68ki_cpu_core;
 /* Build the opcode handler table */
 void m68ki_build_opcode_table(void);
 
-extern void (*m68ki_instruction_jump_table[0x10000])(m68ki_cpu_core*); /* opcode handler jump table */
-extern unsigned char m68ki_cycles[][0x10000];
+/* Opcode dispatch. Instead of a 512 KB table of function pointers, every opcode
+ * maps to a 16 bit index into a small table of handlers with their cycle counts,
+ * which keeps the data touched per instruction small enough to stay in L2.
+ */
+#define M68KI_MAX_DISPATCH 2560
+
+typedef struct
+{
+	void (*opcode_handler)(m68ki_cpu_core*);
+	unsigned char cycles[4]; /* per CPU type: 68000, 68010, 68020, 68030/68040 */
+} m68ki_opcode_dispatch;
+
+extern unsigned short m68ki_instruction_index[0x10000];
+extern m68ki_opcode_dispatch m68ki_instruction_dispatch[M68KI_MAX_DISPATCH];
 
 /* ======================================================================== */
 /* ============================== END OF FILE ============================= */
@@ -0,0 +1,348 @@
+#include "bitBangDecoder.h"
+
+namespace mc68k
+{
+	void BitBangDecoder::attach(Port& _port)
+	{
+		_port.setWriteTXCallback([this](const Port& _p) { onPortChanged(_p); });
+		_port.setDirectionChangeCallback([this](const Port& _p) { onPortChanged(_p); });
+		_port.setReadRXCallback([this](const Port& _p, const uint8_t _data) { return onPortRead(_p, _data); });
+
+		onPortChanged(_port);
+	}
+
+	void BitBangDecoder::process(const std::vector<Port::TXEvent>& _events)
+	{
+		for (const auto& e : _events)
+			onLevels(e.cycle, getLevels(e.data, e.direction));
+	}
+
+	void BitBangDecoder::emitByte(const uint8_t _byte, const uint64_t _cycle)
+	{
+		if(m_byteCallback)
+			m_byteCallback(_byte, _cycle);
+	}
+
+	void BitBangDecoder::emitFrameByte(const uint8_t _byte, const uint64_t _cycle)
+	{
+		emitByte(_byte, _cycle);
+		m_frame.push_back(_byte);
+	}
+
+	void BitBangDecoder::emitFrame(const uint64_t _cycle)
+	{
+		if(m_frame.empty())
+			return;
+		if(m_frameCallback)
+			m_frameCallback(m_frame, _cycle);
+		m_frame.clear();
+	}
+
+	// SPI
+
+	SpiDecoder::SpiDecoder(const uint8_t _clock, const uint8_t _dataOut, const uint8_t _dataIn, const uint8_t _chipSelect, const bool _cpol, const bool _cpha, const bool _msbFirst)
+	: m_clock(_clock), m_dataOut(_dataOut), m_dataIn(_dataIn), m_chipSelect(_chipSelect)
+	, m_cpol(_cpol), m_cpha(_cpha), m_msbFirst(_msbFirst)
+	, m_levels(replaceBit(0xff, _clock, _cpol))
+	{
+	}
+
+	void SpiDecoder::onLevels(const uint64_t _cycle, const uint8_t _levels)
+	{
+		const auto prev = m_levels;
+		m_levels = _levels;
+
+		if(m_chipSelect != NoPin)
+		{
+			const auto wasSelected = !isSet(prev, m_chipSelect);
+			const auto selected = !isSet(_levels, m_chipSelect);
+
+			if(wasSelected && !selected)
+			{
+				// a partially transferred byte is discarded
+				if(m_bitCount)
+					m_txLoaded = false;
+				m_bitCount = 0;
+				m_rxByte = 0;
+				emitFrame(_cycle);
+				return;
+			}
+
+			if(!selected)
+				return;
+		}
+
+		const auto clock = isSet(_levels, m_clock);
+
+		if(clock == isSet(prev, m_clock))
+			return;
+
+		// every byte slot consumes a byte of the send queue, even if the firmware does not read it
+		if(!m_bitCount && !m_txLoaded)
+			nextTxByte();
+
+		// data is sampled on the leading edge for CPHA 0 and on the trailing edge for CPHA 1
+		const auto leading = clock != m_cpol;
+
+		if(leading == m_cpha)
+			return;
+
+		const auto bit = static_cast<uint8_t>(isSet(_levels, m_dataOut) ? 1 : 0);
+
+		m_rxByte = m_msbFirst ? static_cast<uint8_t>((m_rxByte << 1) | bit) : static_cast<uint8_t>((m_rxByte >> 1) | (bit << 7));
+
+		if(++m_bitCount < 8)
+			return;
+
+		emitFrameByte(m_rxByte, _cycle);
+		m_bitCount = 0;
+		m_rxByte = 0;
+		m_txLoaded = false;
+	}
+
+	uint8_t SpiDecoder::serve(uint64_t, const uint8_t _data)
+	{
+		if(m_dataIn == NoPin)
+			return _data;
+
+		if(m_chipSelect != NoPin && isSet(m_levels, m_chipSelect))
+			return _data;
+
+		if(!m_txLoaded)
+			nextTxByte();
+
+		const auto index = m_msbFirst ? 7 - m_bitCount : m_bitCount;
+
+		return replaceBit(_data, m_dataIn, (m_txByte >> index) & 1);
+	}
+
+	void SpiDecoder::nextTxByte()
+	{
+		m_txLoaded = true;
+
+		if(m_dataIn == NoPin || m_txQueue.empty())
+		{
+			m_txByte = 0xff;
+			return;
+		}
+
+		m_txByte = m_txQueue.front();
+		m_txQueue.pop_front();
+	}
+
+	// I2C
+
+	I2cDecoder::I2cDecoder(const uint8_t _scl, const uint8_t _sda) : m_scl(_scl), m_sda(_sda)
+	{
+	}
+
+	void I2cDecoder::onLevels(const uint64_t _cycle, const uint8_t _levels)
+	{
+		const auto prev = m_levels;
+		m_levels = _levels;
+
+		const auto sclPrev = isSet(prev, m_scl);
+		const auto scl = isSet(_levels, m_scl);
+		const auto sda = isSet(_levels, m_sda);
+
+		// SDA changes while SCL is high are start and stop conditions
+		if(sclPrev && scl && sda != isSet(prev, m_sda))
+		{
+			emitFrame(_cycle);
+
+			m_state = sda ? State::Idle : State::Address;
+			m_addressed = false;
+			m_ack = false;
+			m_bitCount = 0;
+			m_servedBit = 0;
+			m_byte = 0;
+			return;
+		}
+
+		if(m_state == State::Idle)
+			return;
+
+		if(!sclPrev && scl)
+		{
+			const auto bus = sda && getSlaveSda();
+
+			if(m_bitCount < 8)
+			{
+				m_byte = static_cast<uint8_t>((m_byte << 1) | (bus ? 1 : 0));
+				if(++m_bitCount == 8)
+					onByte(_cycle);
+			}
+			else
+			{
+				// acknowledge clock
+				m_bitCount = 0;
+				m_byte = 0;
+			}
+		}
+		else if(sclPrev && !scl)
+		{
+			m_servedBit = m_bitCount;
+
+			if(m_state == State::Read && !m_bitCount && !m_txLoaded)
+			{
+				m_txLoaded = true;
+				m_txByte = 0xff;
+
+				if(m_addressed && !m_txQueue.empty())
+				{
+					m_txByte = m_txQueue.front();
+					m_txQueue.pop_front();
+				}
+			}
+		}
+	}
+
+	uint8_t I2cDecoder::serve(uint64_t, const uint8_t _data)
+	{
+		if(getSlaveSda())
+			return _data;
+		return replaceBit(_data, m_sda, false);
+	}
+
+	bool I2cDecoder::getSlaveSda() const
+	{
+		if(!m_slave || m_state == State::Idle)
+			return true;
+
+		if(m_servedBit == 8)
+			return !m_ack;
+
+		if(m_state == State::Read && m_addressed)
+			return (m_txByte >> (7 - m_servedBit)) & 1;
+
+		return true;
+	}
+
+	void I2cDecoder::onByte(const uint64_t _cycle)
+	{
+		emitFrameByte(m_byte, _cycle);
+
+		switch (m_state)
+		{
+		case State::Address:
+			m_addressed = m_slave && (m_slaveAddress == AnyAddress || (m_byte >> 1) == m_slaveAddress);
+			m_ack = m_addressed;
+			m_state = (m_byte & 1) ? State::Read : State::Write;
+			m_txLoaded = false;
+			break;
+		case State::Write:
+			m_ack = m_addressed;
+			break;
+		case State::Read:
+			// the master acknowledges
+			m_ack = false;
+			m_txLoaded = false;
+			break;
+		default:
+			break;
+		}
+	}
+
+	// UART
+
+	UartDecoder::UartDecoder(const uint8_t _tx, const uint8_t _rx, const double _cyclesPerBit) : m_tx(_tx), m_rx(_rx), m_cyclesPerBit(_cyclesPerBit)
+	{
+	}
+
+	void UartDecoder::onLevels(const uint64_t _cycle, const uint8_t _levels)
+	{
+		if(m_tx == NoPin)
+			return;
+
+		flush(_cycle);
+
+		const auto level = isSet(_levels, m_tx);
+
+		if(level == m_level)
+			return;
+
+		m_level = level;
+
+		if(!level && !m_rxActive)
+		{
+			m_rxActive = true;
+			m_rxStart = _cycle;
+			m_rxBit = 0;
+			m_rxByte = 0;
+		}
+	}
+
+	void UartDecoder::flush(const uint64_t _cycle)
+	{
+		// the line level is constant since the last change, sample all bits whose center is before the given cycle
+		while(m_rxActive)
+		{
+			const auto t = getBitCycle(m_rxStart, m_rxBit + 0.5);
+
+			if(t >= _cycle)
+				return;
+
+			if(m_rxBit == 0)
+			{
+				// glitch, not a start bit
+				if(m_level)
+				{
+					m_rxActive = false;
+					return;
+				}
+			}
+			else if(m_rxBit <= 8)
+			{
+				m_rxByte |= static_cast<uint8_t>((m_level ? 1 : 0) << (m_rxBit - 1));
+			}
+			else
+			{
+				if(m_level)
+					emitByte(m_rxByte, t);
+				else
+					++m_framingErrors;
+
+				m_rxActive = false;
+				return;
+			}
+
+			++m_rxBit;
+		}
+	}
+
+	uint8_t UartDecoder::serve(const uint64_t _cycle, const uint8_t _data)
+	{
+		if(m_rx == NoPin)
+			return _data;
+
+		while(m_txActive || !m_txQueue.empty())
+		{
+			if(!m_txActive)
+			{
+				m_txActive = true;
+				m_txStart = _cycle;
+			}
+
+			const auto bit = static_cast<uint32_t>(static_cast<double>(_cycle - m_txStart) / m_cyclesPerBit);
+
+			if(bit < 10)
+			{
+				// start bit, eight data bits LSB first, stop bit
+				const auto level = bit == 0 ? false : bit == 9 || ((m_txQueue.front() >> (bit - 1)) & 1);
+				return replaceBit(_data, m_rx, level);
+			}
+
+			// the next byte follows back to back
+			m_txQueue.pop_front();
+			m_txStart = getBitCycle(m_txStart, 10);
+			m_txActive = !m_txQueue.empty();
+		}
+
+		return replaceBit(_data, m_rx, true);
+	}
+
+	uint64_t UartDecoder::getBitCycle(const uint64_t _start, const double _bit) const
+	{
+		return _start + static_cast<uint64_t>(_bit * m_cyclesPerBit);
+	}
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "peripheralTypes.h"
+#include "port.h"
+
+namespace mc68k
+{
+	// Decodes serial protocols that the firmware bit-bangs on port pins. A decoder either observes a port live via its
+	// callbacks, see attach(), or processes entries drained from the TX log of a port in bulk. Pins are identified by
+	// their bit number, see the pin enums in peripheralTypes.h.
+	// Output pins are seen at their driven level, pins that are configured as input are seen as pulled up.
+	// Inputs served to the firmware via Port::read depend on the current protocol state and therefore require live mode.
+	// Decoders are not thread safe, send() has to be called on the emulation thread, for example from a host event of
+	// the EventMailbox
+	class BitBangDecoder
+	{
+	public:
+		static constexpr uint8_t NoPin = 0xff;
+
+		using ByteCallback = std::function<void(uint8_t _byte, uint64_t _cycle)>;
+		using FrameCallback = std::function<void(const std::vector<uint8_t>& _frame, uint64_t _cycle)>;
+
+		virtual ~BitBangDecoder() = default;
+
+		// installs write, direction change and read callbacks on the port
+		void attach(Port& _port);
+
+		// to be called from port callbacks if multiple decoders share a port
+		void onPortChanged(const Port& _port)
+		{
+			onLevels(_port.getCycles(), getLevels(_port.getData(), _port.getDirection()));
+		}
+
+		uint8_t onPortRead(const Port& _port, const uint8_t _data)
+		{
+			return serve(_port.getCycles(), _data);
+		}
+
+		void process(const std::vector<Port::TXEvent>& _events);
+
+		// finishes pending timed decoding up to the given cycle
+		virtual void flush(uint64_t /*_cycle*/) {}
+
+		void setByteCallback(const ByteCallback& _callback) { m_byteCallback = _callback; }
+		void setFrameCallback(const FrameCallback& _callback) { m_frameCallback = _callback; }
+
+	protected:
+		static uint8_t getLevels(const uint8_t _data, const uint8_t _direction)
+		{
+			return static_cast<uint8_t>((_data & _direction) | ~_direction);
+		}
+
+		static bool isSet(const uint8_t _levels, const uint8_t _pin)
+		{
+			return (_levels >> _pin) & 1;
+		}
+
+		static uint8_t replaceBit(const uint8_t _data, const uint8_t _pin, const bool _level)
+		{
+			return static_cast<uint8_t>(_level ? _data | (1 << _pin) : _data & ~(1 << _pin));
+		}
+
+		virtual void onLevels(uint64_t _cycle, uint8_t _levels) = 0;
+		virtual uint8_t serve(uint64_t /*_cycle*/, uint8_t _data) { return _data; }
+
+		void emitByte(uint8_t _byte, uint64_t _cycle);
+		void emitFrameByte(uint8_t _byte, uint64_t _cycle);
+		void emitFrame(uint64_t _cycle);
+
+	private:
+		ByteCallback m_byteCallback;
+		FrameCallback m_frameCallback;
+		std::vector<uint8_t> m_frame;
+	};
+
+	// Clocked serial, SPI modes 0-3. Bytes are sampled from the data out pin on the sampling clock edge, a frame is
+	// emitted when the optional active low chip select is released. Bytes passed to send() are served on the data in pin
+	class SpiDecoder final : public BitBangDecoder
+	{
+	public:
+		SpiDecoder(uint8_t _clock, uint8_t _dataOut, uint8_t _dataIn = NoPin, uint8_t _chipSelect = NoPin, bool _cpol = false, bool _cpha = false, bool _msbFirst = true);
+
+		void send(uint8_t _byte) { m_txQueue.push_back(_byte); }
+
+	private:
+		void onLevels(uint64_t _cycle, uint8_t _levels) override;
+		uint8_t serve(uint64_t _cycle, uint8_t _data) override;
+		void nextTxByte();
+
+		const uint8_t m_clock, m_dataOut, m_dataIn, m_chipSelect;
+		const bool m_cpol, m_cpha, m_msbFirst;
+
+		uint8_t m_levels = 0xff;
+		uint8_t m_bitCount = 0;
+		uint8_t m_rxByte = 0;
+		uint8_t m_txByte = 0xff;
+		bool m_txLoaded = false;
+		std::deque<uint8_t> m_txQueue;
+	};
+
+	// I2C as bus master driven by the firmware, usually open drain by switching the pin direction. All bytes including
+	// the address byte are emitted, a frame is emitted on a stop or repeated start condition with the address byte first.
+	// Optionally acts as slave: acknowledges its address and written bytes and serves bytes passed to send() on reads
+	class I2cDecoder final : public BitBangDecoder
+	{
+	public:
+		static constexpr uint8_t AnyAddress = 0xff;
+
+		I2cDecoder(uint8_t _scl, uint8_t _sda);
+
+		void enableSlave(uint8_t _address = AnyAddress) { m_slaveAddress = _address; m_slave = true; }
+		void disableSlave() { m_slave = false; }
+
+		void send(uint8_t _byte) { m_txQueue.push_back(_byte); }
+
+	private:
+		enum class State : uint8_t
+		{
+			Idle,
+			Address,
+			Write,
+			Read
+		};
+
+		void onLevels(uint64_t _cycle, uint8_t _levels) override;
+		uint8_t serve(uint64_t _cycle, uint8_t _data) override;
+		bool getSlaveSda() const;
+		void onByte(uint64_t _cycle);
+
+		const uint8_t m_scl, m_sda;
+
+		bool m_slave = false;
+		uint8_t m_slaveAddress = AnyAddress;
+		bool m_addressed = false;
+		bool m_ack = false;
+
+		uint8_t m_levels = 0xff;
+		State m_state = State::Idle;
+		uint8_t m_bitCount = 0;
+		uint8_t m_servedBit = 0;		// bit count at the last falling edge of SCL, the slave changes SDA while SCL is low
+		uint8_t m_byte = 0;
+		uint8_t m_txByte = 0xff;
+		bool m_txLoaded = false;
+		std::deque<uint8_t> m_txQueue;
+	};
+
+	// Asynchronous serial, 8N1. Frames on the transmit pin are sampled in the middle of each bit, the last frame may only
+	// be complete after flush(). Bytes passed to send() are served on the receive pin, starting with the first read of
+	// the port after they have been queued
+	class UartDecoder final : public BitBangDecoder
+	{
+	public:
+		UartDecoder(uint8_t _tx, uint8_t _rx, double _cyclesPerBit);
+
+		void setCyclesPerBit(const double _cyclesPerBit) { m_cyclesPerBit = _cyclesPerBit; }
+
+		void send(uint8_t _byte) { m_txQueue.push_back(_byte); }
+
+		void flush(uint64_t _cycle) override;
+
+		uint32_t getFramingErrors() const { return m_framingErrors; }
+
+	private:
+		void onLevels(uint64_t _cycle, uint8_t _levels) override;
+		uint8_t serve(uint64_t _cycle, uint8_t _data) override;
+		uint64_t getBitCycle(uint64_t _start, double _bit) const;
+
+		const uint8_t m_tx, m_rx;
+		double m_cyclesPerBit;
+
+		bool m_level = true;
+		bool m_rxActive = false;
+		uint64_t m_rxStart = 0;
+		uint8_t m_rxBit = 0;
+		uint8_t m_rxByte = 0;
+		uint32_t m_framingErrors = 0;
+
+		bool m_txActive = false;
+		uint64_t m_txStart = 0;
+		std::deque<uint8_t> m_txQueue;
+	};
+}
@@ -0,0 +1,109 @@
+#include "blockRunner.h"
+
+#include <algorithm>
+
+#include "hdi08.h"
+#include "mc68k.h"
+
+namespace mc68k
+{
+	BlockRunner::BlockRunner(Mc68k& _mc68k) : m_mc68k(_mc68k), m_base(_mc68k.getCycles()), m_blockStart(m_base)
+	{
+	}
+
+	uint8_t BlockRunner::addHdi08(Hdi08& _hdi)
+	{
+		const auto index = static_cast<uint8_t>(m_hdi08s.size());
+		m_hdi08s.push_back(&_hdi);
+
+		_hdi.setWriteTxCallback([this, index](const uint32_t _word)
+		{
+			m_hdiOutputs.push_back({m_mc68k.getCycles(), 0, _word, OutputType::Hdi08Tx, index});
+		});
+
+		return index;
+	}
+
+	uint8_t BlockRunner::addPort(Port& _port, const uint32_t _logCapacity/* = 4096*/)
+	{
+		_port.enableTXLog(_logCapacity);
+		m_ports.push_back(&_port);
+		return static_cast<uint8_t>(m_ports.size() - 1);
+	}
+
+	StopReason BlockRunner::run(const uint32_t _samples, const uint32_t _sampleRate, std::vector<Output>& _outputs)
+	{
+		const auto clockHz = m_mc68k.getSim().getSystemClockHz();
+
+		if(clockHz != m_clockHz || _sampleRate != m_sampleRate)
+		{
+			m_base = m_blockStart;
+			m_samples = 0;
+			m_clockHz = clockHz;
+			m_sampleRate = _sampleRate;
+		}
+
+		const auto blockStart = m_blockStart;
+		const auto blockEnd = getTargetCycle(m_samples + _samples);
+
+		auto reason = StopReason::None;
+
+		if(m_mc68k.getCycles() < blockEnd)
+			reason = m_mc68k.run(blockEnd - m_mc68k.getCycles());
+
+		// a block that stopped early at a breakpoint or watchpoint is continued by the next call
+		if(reason == StopReason::None)
+		{
+			m_samples += _samples;
+			m_blockStart = blockEnd;
+
+			// keep m_samples below one second to prevent m_samples * m_clockHz from overflowing
+			while(m_samples >= m_sampleRate && m_sampleRate)
+			{
+				m_base += m_clockHz;
+				m_samples -= m_sampleRate;
+			}
+		}
+
+		const auto first = _outputs.size();
+
+		_outputs.insert(_outputs.end(), m_hdiOutputs.begin(), m_hdiOutputs.end());
+		m_hdiOutputs.clear();
+
+		m_mc68k.getQSM().readSciTX(m_sciData);
+		for (const auto& d : m_sciData)
+			_outputs.push_back({d.cycle, 0, d.data, OutputType::SciTx, 0});
+		m_sciData.clear();
+
+		for(size_t p=0; p<m_ports.size(); ++p)
+		{
+			m_ports[p]->drainTXLog(m_portEvents);
+			for (const auto& e : m_portEvents)
+				_outputs.push_back({e.cycle, 0, static_cast<uint32_t>(e.data | (e.direction << 8)), OutputType::PortTx, static_cast<uint8_t>(p)});
+			m_portEvents.clear();
+		}
+
+		std::stable_sort(_outputs.begin() + static_cast<ptrdiff_t>(first), _outputs.end(), [](const Output& _a, const Output& _b)
+		{
+			return _a.cycle < _b.cycle;
+		});
+
+		const auto lastSample = _samples ? _samples - 1 : 0;
+
+		for(auto i = first; i < _outputs.size(); ++i)
+		{
+			auto& o = _outputs[i];
+			const auto offset = o.cycle > blockStart ? (o.cycle - blockStart) * m_sampleRate / m_clockHz : 0;
+			o.sampleOffset = static_cast<uint32_t>(std::min<uint64_t>(offset, lastSample));
+		}
+
+		return reason;
+	}
+
+	uint64_t BlockRunner::getTargetCycle(const uint64_t _samples) const
+	{
+		if(!m_sampleRate)
+			return m_base;
+		return m_base + _samples * m_clockHz / m_sampleRate;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "port.h"
+#include "qsm.h"
+
+namespace mc68k
+{
+	class Hdi08;
+	class Mc68k;
+	enum class StopReason : uint8_t;
+
+	// Runs the emulation per audio block. The number of cycles per block is derived from the system clock of the SIM and
+	// the sample rate, the position is tracked as an exact fraction so that blocks do not drift against the audio clock.
+	// Outputs that the firmware generates during a block are returned with their cycle and the sample offset within the
+	// block. Ports added to the runner are switched to their TX log, HDI08 transmit callbacks are replaced
+	class BlockRunner
+	{
+	public:
+		enum class OutputType : uint8_t
+		{
+			Hdi08Tx,
+			SciTx,
+			PortTx
+		};
+
+		struct Output
+		{
+			uint64_t cycle;
+			uint32_t sampleOffset;
+			uint32_t data;			// HDI08 word, SCI data or port data in bits 0-7 and direction in bits 8-15
+			OutputType type;
+			uint8_t source;			// HDI08 or port index as returned by addHdi08() / addPort()
+		};
+
+		explicit BlockRunner(Mc68k& _mc68k);
+
+		uint8_t addHdi08(Hdi08& _hdi);
+		uint8_t addPort(Port& _port, uint32_t _logCapacity = 4096);
+
+		// executes _samples samples at _sampleRate and appends all outputs of the block to _outputs, sorted by cycle
+		StopReason run(uint32_t _samples, uint32_t _sampleRate, std::vector<Output>& _outputs);
+
+		// ideal cycle at which the next block starts
+		uint64_t getBlockStartCycle() const { return m_blockStart; }
+
+	private:
+		uint64_t getTargetCycle(uint64_t _samples) const;
+
+		Mc68k& m_mc68k;
+
+		std::vector<Hdi08*> m_hdi08s;
+		std::vector<Port*> m_ports;
+
+		// block position: m_base + m_samples * m_clockHz / m_sampleRate, rebased if clock or sample rate change
+		uint64_t m_base = 0;
+		uint64_t m_samples = 0;
+		uint32_t m_clockHz = 0;
+		uint32_t m_sampleRate = 0;
+		uint64_t m_blockStart = 0;
+
+		std::vector<Output> m_hdiOutputs;
+		std::deque<Qsm::SciData> m_sciData;
+		std::vector<Port::TXEvent> m_portEvents;
+	};
+}
@@ -0,0 +1,296 @@
+#include "codeAnalyzer.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "cpuState.h"
+#include "logging.h"
+#include "mc68k.h"
+
+namespace mc68k
+{
+	void CodeAnalyzer::analyze(Mc68k& _mc68k, const uint32_t _first, const uint32_t _count, const bool _useVectorTable/* = true*/, const std::vector<uint32_t>& _additionalEntryPoints/* = {}*/)
+	{
+		clear();
+
+		m_first = _first;
+		m_count = _count;
+
+		const auto cpuType = m68k_get_reg(_mc68k.getCpuState(), M68K_REG_CPU_TYPE);
+
+		addEntryPoint(_mc68k.getResetPC(), true);
+
+		if(_useVectorTable)
+		{
+			const auto vbr = m68k_get_reg(_mc68k.getCpuState(), M68K_REG_VBR);
+
+			// vector 0 is the initial stack pointer and vector 1 the reset PC
+			for(uint32_t i=2; i<256; ++i)
+			{
+				const auto a = vbr + (i<<2);
+				const auto v = _mc68k.peek32(a);
+				addEntryPoint(v, true);
+			}
+		}
+
+		for (const auto addr : _additionalEntryPoints)
+			addEntryPoint(addr, true);
+
+		while(!m_worklist.empty())
+		{
+			const auto addr = m_worklist.back();
+			m_worklist.pop_back();
+			decodeFrom(_mc68k, addr, cpuType);
+		}
+
+		buildBlocks();
+		buildFunctions();
+
+		MCLOG("Code analysis found " << m_functions.size() << " functions, " << m_blocks.size() << " basic blocks and " << m_instructions.size() << " instructions");
+
+		m_instructions.clear();
+		m_leaders.clear();
+		m_functionEntries.clear();
+	}
+
+	void CodeAnalyzer::clear()
+	{
+		m_first = m_count = 0;
+		m_instructions.clear();
+		m_worklist.clear();
+		m_leaders.clear();
+		m_functionEntries.clear();
+		m_blocks.clear();
+		m_functions.clear();
+	}
+
+	const CodeAnalyzer::BasicBlock* CodeAnalyzer::findBlock(const uint32_t _addr) const
+	{
+		auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), _addr, [](const uint32_t _a, const BasicBlock& _b)
+		{
+			return _a < _b.start;
+		});
+
+		if(it == m_blocks.begin())
+			return nullptr;
+
+		--it;
+
+		return _addr < it->end ? &*it : nullptr;
+	}
+
+	const CodeAnalyzer::Function* CodeAnalyzer::findFunction(const uint32_t _addr) const
+	{
+		const auto* block = findBlock(_addr);
+
+		if(!block || block->function == InvalidAddress)
+			return nullptr;
+
+		const auto it = std::lower_bound(m_functions.begin(), m_functions.end(), block->function, [](const Function& _f, const uint32_t _a)
+		{
+			return _f.entry < _a;
+		});
+
+		return it != m_functions.end() && it->entry == block->function ? &*it : nullptr;
+	}
+
+	bool CodeAnalyzer::dump(const std::string& _filename) const
+	{
+		std::ofstream f(_filename, std::ios::out);
+
+		if(!f.is_open())
+			return false;
+
+		for (const auto& func : m_functions)
+		{
+			f << "function " << MCHEXN(func.entry, 6) << ": blocks=" << std::dec << func.blockCount << ", instructions=" << func.instructionCount << ", calls=" << func.callCount << '\n';
+
+			for (const auto& block : m_blocks)
+			{
+				if(block.function != func.entry)
+					continue;
+
+				f << '\t' << MCHEXN(block.start, 6) << '-' << MCHEXN(block.end, 6) << " ->";
+
+				for (const auto s : block.successors)
+					f << ' ' << MCHEXN(s, 6);
+
+				if(block.callTarget != InvalidAddress)
+					f << " call " << MCHEXN(block.callTarget, 6);
+
+				f << '\n';
+			}
+			f << '\n';
+		}
+
+		return true;
+	}
+
+	void CodeAnalyzer::addEntryPoint(const uint32_t _addr, const bool _isFunction)
+	{
+		if(!isInRange(_addr))
+			return;
+
+		if(_isFunction)
+			m_functionEntries.insert(std::make_pair(_addr, 0));
+
+		m_leaders.push_back(_addr);
+		m_worklist.push_back(_addr);
+	}
+
+	void CodeAnalyzer::decodeFrom(Mc68k& _mc68k, uint32_t _addr, const uint32_t _cpuType)
+	{
+		while(isInRange(_addr) && m_instructions.find(_addr) == m_instructions.end())
+		{
+			const auto e = DisasmCache::decode(_mc68k, _addr, _cpuType);
+
+			m_instructions.insert(std::make_pair(_addr, e));
+
+			const auto next = _addr + e.length;
+
+			switch (e.type)
+			{
+			case DisasmCache::InstructionType::Invalid:
+			case DisasmCache::InstructionType::Return:
+				return;
+			case DisasmCache::InstructionType::Branch:
+			case DisasmCache::InstructionType::Jump:
+				// jumps through registers or jump tables cannot be followed statically
+				addEntryPoint(e.target, false);
+				return;
+			case DisasmCache::InstructionType::ConditionalBranch:
+				addEntryPoint(e.target, false);
+				m_leaders.push_back(next);
+				break;
+			case DisasmCache::InstructionType::Call:
+				addEntryPoint(e.target, true);
+				if(isInRange(e.target))
+					++m_functionEntries[e.target];
+				m_leaders.push_back(next);
+				break;
+			case DisasmCache::InstructionType::Normal:
+				break;
+			}
+
+			_addr = next;
+		}
+	}
+
+	void CodeAnalyzer::buildBlocks()
+	{
+		std::sort(m_leaders.begin(), m_leaders.end());
+		m_leaders.erase(std::unique(m_leaders.begin(), m_leaders.end()), m_leaders.end());
+
+		auto isDecoded = [&](const uint32_t _addr)
+		{
+			return m_instructions.find(_addr) != m_instructions.end();
+		};
+
+		auto finalize = [&](BasicBlock& _block, const DisasmCache::Entry& _last)
+		{
+			auto addSuccessor = [&](const uint32_t _addr)
+			{
+				if(_addr != DisasmCache::InvalidTarget && isDecoded(_addr))
+					_block.successors.push_back(_addr);
+			};
+
+			switch (_last.type)
+			{
+			case DisasmCache::InstructionType::Invalid:
+			case DisasmCache::InstructionType::Return:
+				break;
+			case DisasmCache::InstructionType::Branch:
+			case DisasmCache::InstructionType::Jump:
+				addSuccessor(_last.target);
+				break;
+			case DisasmCache::InstructionType::ConditionalBranch:
+				addSuccessor(_last.target);
+				addSuccessor(_block.end);
+				break;
+			case DisasmCache::InstructionType::Call:
+				_block.callTarget = _last.target;
+				addSuccessor(_block.end);
+				break;
+			case DisasmCache::InstructionType::Normal:
+				addSuccessor(_block.end);
+				break;
+			}
+		};
+
+		const DisasmCache::Entry* last = nullptr;
+
+		for (const auto& [addr, e] : m_instructions)
+		{
+			const bool startNew = !last ||
+				last->type != DisasmCache::InstructionType::Normal ||
+				addr != m_blocks.back().end ||
+				std::binary_search(m_leaders.begin(), m_leaders.end(), addr);
+
+			if(startNew)
+			{
+				if(last)
+					finalize(m_blocks.back(), *last);
+
+				BasicBlock b;
+				b.start = b.end = addr;
+				b.instructionCount = 0;
+				m_blocks.push_back(b);
+			}
+
+			auto& block = m_blocks.back();
+			block.end = addr + e.length;
+			++block.instructionCount;
+
+			last = &e;
+		}
+
+		if(last)
+			finalize(m_blocks.back(), *last);
+	}
+
+	void CodeAnalyzer::buildFunctions()
+	{
+		auto findBlockByStart = [&](const uint32_t _addr) -> BasicBlock*
+		{
+			const auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), _addr, [](const BasicBlock& _b, const uint32_t _a)
+			{
+				return _b.start < _a;
+			});
+			return it != m_blocks.end() && it->start == _addr ? &*it : nullptr;
+		};
+
+		std::vector<uint32_t> stack;
+
+		for (const auto& [entry, callCount] : m_functionEntries)
+		{
+			Function func;
+			func.entry = entry;
+			func.callCount = callCount;
+
+			stack.push_back(entry);
+
+			while(!stack.empty())
+			{
+				auto* block = findBlockByStart(stack.back());
+				stack.pop_back();
+
+				if(!block || block->function != InvalidAddress)
+					continue;
+
+				block->function = entry;
+				++func.blockCount;
+				func.instructionCount += block->instructionCount;
+
+				// a branch to the entry of another function is a tail call, it does not belong to this function
+				for (const auto s : block->successors)
+				{
+					if(s == entry || m_functionEntries.find(s) == m_functionEntries.end())
+						stack.push_back(s);
+				}
+			}
+
+			if(func.blockCount)
+				m_functions.push_back(func);
+		}
+	}
+}
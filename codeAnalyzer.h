@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "disasmCache.h"
+
+namespace mc68k
+{
+	class Mc68k;
+
+	// Recursive descent analysis of a code image. Starting at the reset PC, the exception vector table and any
+	// additional entry points, it follows branches, jumps and calls with statically known targets and builds a basic
+	// block graph and a list of functions
+	class CodeAnalyzer
+	{
+	public:
+		static constexpr uint32_t InvalidAddress = 0xffffffff;
+
+		struct BasicBlock
+		{
+			uint32_t start;
+			uint32_t end;						// exclusive
+			uint32_t instructionCount;
+			uint32_t function = InvalidAddress;	// entry address of the function this block belongs to
+			std::vector<uint32_t> successors;	// start addresses of the blocks control flow may continue at, calls excluded
+			uint32_t callTarget = InvalidAddress;
+		};
+
+		struct Function
+		{
+			uint32_t entry;
+			uint32_t blockCount = 0;
+			uint32_t instructionCount = 0;
+			uint32_t callCount = 0;				// number of call sites that have been found
+		};
+
+		// only code within [_first, _first + _count) is analyzed
+		void analyze(Mc68k& _mc68k, uint32_t _first, uint32_t _count, bool _useVectorTable = true, const std::vector<uint32_t>& _additionalEntryPoints = {});
+		void clear();
+
+		const std::vector<BasicBlock>& getBlocks() const { return m_blocks; }
+		const std::vector<Function>& getFunctions() const { return m_functions; }
+
+		// returns the block / function that contains _addr or nullptr if it has not been discovered
+		const BasicBlock* findBlock(uint32_t _addr) const;
+		const Function* findFunction(uint32_t _addr) const;
+
+		bool dump(const std::string& _filename) const;
+
+	private:
+		bool isInRange(const uint32_t _addr) const { return !(_addr & 1) && _addr >= m_first && _addr - m_first < m_count; }
+
+		void addEntryPoint(uint32_t _addr, bool _isFunction);
+		void decodeFrom(Mc68k& _mc68k, uint32_t _addr, uint32_t _cpuType);
+		void buildBlocks();
+		void buildFunctions();
+
+		uint32_t m_first = 0;
+		uint32_t m_count = 0;
+
+		std::map<uint32_t, DisasmCache::Entry> m_instructions;
+		std::vector<uint32_t> m_worklist;
+		std::vector<uint32_t> m_leaders;
+		std::map<uint32_t, uint32_t> m_functionEntries;	// entry => call count
+
+		std::vector<BasicBlock> m_blocks;
+		std::vector<Function> m_functions;
+	};
+}
@@ -0,0 +1,284 @@
+#include "disasmCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "cpuState.h"
+#include "mc68k.h"
+
+namespace mc68k
+{
+	void DisasmCache::build(Mc68k& _mc68k, const uint32_t _first, const uint32_t _count, const uint32_t _threadCount/* = 1*/)
+	{
+		clear();
+
+		m_first = _first;
+		m_count = _count;
+
+		const auto end = _first + _count;
+
+		// disassemble once on this thread to have the shared disassembler tables initialized before going parallel
+		char disasm[64];
+		_mc68k.disassemble(_first, disasm);
+
+		const auto cpuType = m68k_get_reg(_mc68k.getCpuState(), M68K_REG_CPU_TYPE);
+
+		// Worker threads read code via Mc68k::peek16(), which is only free of side effects and safe to call concurrently
+		// if the range is backed by host memory. The last chunk is swept on this thread as instructions at its end may
+		// extend beyond the range
+		const auto threadCount = _mc68k.isPeekDirect(_first, _count) ? std::min(getThreadCount(_threadCount), std::max(1u, _count / 1024)) : 1;
+
+		std::vector<std::vector<Entry>> chunks(threadCount);
+		std::vector<uint32_t> chunkStarts(threadCount + 1);
+
+		for(uint32_t i=0; i<threadCount; ++i)
+			chunkStarts[i] = _first + ((static_cast<uint64_t>(_count) * i / threadCount) & ~1ull);
+		chunkStarts[threadCount] = end;
+
+		if(threadCount == 1)
+		{
+			sweep(_mc68k, _first, end, cpuType, chunks[0]);
+		}
+		else
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(threadCount - 1);
+
+			for(uint32_t i=0; i<threadCount - 1; ++i)
+			{
+				threads.emplace_back([&, i]
+				{
+					sweep(_mc68k, chunkStarts[i], chunkStarts[i+1], cpuType, chunks[i]);
+				});
+			}
+
+			sweep(_mc68k, chunkStarts[threadCount - 1], end, cpuType, chunks[threadCount - 1]);
+
+			for (auto& t : threads)
+				t.join();
+		}
+
+		// Each chunk has been swept from an arbitrary start address, which may be in the middle of an instruction of
+		// the previous chunk. Continue sequentially from the true end of the previous chunk until the sweep
+		// synchronizes with an instruction start of the current chunk
+		m_entries = std::move(chunks[0]);
+
+		for(uint32_t c=1; c<threadCount; ++c)
+		{
+			const auto& chunk = chunks[c];
+
+			auto next = m_entries.empty() ? chunkStarts[c] : m_entries.back().address + m_entries.back().length;
+
+			auto findNext = [&]
+			{
+				return std::lower_bound(chunk.begin(), chunk.end(), next, [](const Entry& _e, const uint32_t _addr)
+				{
+					return _e.address < _addr;
+				});
+			};
+
+			auto it = findNext();
+
+			while(it != chunk.end() && it->address != next)
+			{
+				m_entries.push_back(decode(_mc68k, next, cpuType));
+				next += m_entries.back().length;
+				it = findNext();
+			}
+
+			m_entries.insert(m_entries.end(), it, chunk.end());
+		}
+
+		m_index.assign((_count + 1) >> 1, InvalidIndex);
+
+		for(size_t i=0; i<m_entries.size(); ++i)
+		{
+			const auto& e = m_entries[i];
+			if(contains(e.address))
+				m_index[(e.address - m_first) >> 1] = static_cast<uint32_t>(i);
+		}
+	}
+
+	void DisasmCache::clear()
+	{
+		m_first = 0;
+		m_count = 0;
+		m_entries.clear();
+		m_index.clear();
+	}
+
+	bool DisasmCache::dump(Mc68k& _mc68k, const std::string& _filename, const bool _splitFunctions, const uint32_t _threadCount/* = 1*/) const
+	{
+		FILE* f = fopen(_filename.c_str(), "wb");
+
+		if(!f)
+			return false;
+
+		// same restrictions as in build()
+		const auto threadCount = _mc68k.isPeekDirect(m_first, m_count) ? std::min(getThreadCount(_threadCount), std::max(1u, static_cast<uint32_t>(m_entries.size() / 1024))) : 1;
+
+		std::vector<std::string> texts(threadCount);
+
+		auto dumpRange = [&](const size_t _begin, const size_t _end, std::string& _text)
+		{
+			char line[128];
+
+			_text.reserve((_end - _begin) * 32);
+
+			for(size_t i=_begin; i<_end; ++i)
+			{
+				const auto& e = m_entries[i];
+
+				char disasm[64];
+				_mc68k.disassemble(e.address, disasm);
+
+				const auto len = snprintf(line, sizeof(line), "%06x: %s\n", e.address, disasm);
+				_text.append(line, std::min(static_cast<size_t>(len), sizeof(line) - 1));
+
+				if(_splitFunctions && (e.type == InstructionType::Return || e.type == InstructionType::Branch || e.type == InstructionType::Jump))
+					_text.push_back('\n');
+			}
+		};
+
+		if(threadCount == 1)
+		{
+			dumpRange(0, m_entries.size(), texts[0]);
+		}
+		else
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(threadCount - 1);
+
+			for(uint32_t i=0; i<threadCount - 1; ++i)
+			{
+				threads.emplace_back([&, i]
+				{
+					dumpRange(m_entries.size() * i / threadCount, m_entries.size() * (i+1) / threadCount, texts[i]);
+				});
+			}
+
+			dumpRange(m_entries.size() * (threadCount - 1) / threadCount, m_entries.size(), texts[threadCount - 1]);
+
+			for (auto& t : threads)
+				t.join();
+		}
+
+		for (const auto& text : texts)
+			fwrite(text.data(), 1, text.size(), f);
+
+		fclose(f);
+		return true;
+	}
+
+	DisasmCache::InstructionType DisasmCache::getInstructionType(const uint16_t* _words, const uint32_t _pc, uint32_t& _target)
+	{
+		const auto op = _words[0];
+
+		_target = InvalidTarget;
+
+		auto eaTarget = [&]
+		{
+			const auto mode = (op >> 3) & 7;
+			const auto reg = op & 7;
+
+			if(mode != 7)
+				return;
+
+			switch (reg)
+			{
+			case 0:	_target = static_cast<uint32_t>(static_cast<int16_t>(_words[1]));							break;	// (xxx).w
+			case 1:	_target = static_cast<uint32_t>(_words[1]) << 16 | _words[2];								break;	// (xxx).l
+			case 2:	_target = _pc + 2 + static_cast<uint32_t>(static_cast<int16_t>(_words[1]));				break;	// (d16,pc)
+			default: break;
+			}
+		};
+
+		switch (op)
+		{
+		case 0x4e73:	// rte
+		case 0x4e74:	// rtd
+		case 0x4e75:	// rts
+		case 0x4e77:	// rtr
+			return InstructionType::Return;
+		default:
+			break;
+		}
+
+		if((op & 0xffc0) == 0x4ec0)
+		{
+			eaTarget();
+			return InstructionType::Jump;
+		}
+
+		if((op & 0xffc0) == 0x4e80)
+		{
+			eaTarget();
+			return InstructionType::Call;
+		}
+
+		if((op & 0xf0f8) == 0x50c8)
+		{
+			_target = _pc + 2 + static_cast<uint32_t>(static_cast<int16_t>(_words[1]));
+			return InstructionType::ConditionalBranch;
+		}
+
+		if((op & 0xf000) == 0x6000)
+		{
+			const auto disp8 = op & 0xff;
+
+			if(disp8 == 0)
+				_target = _pc + 2 + static_cast<uint32_t>(static_cast<int16_t>(_words[1]));
+			else if(disp8 == 0xff)
+				_target = _pc + 2 + (static_cast<uint32_t>(_words[1]) << 16 | _words[2]);
+			else
+				_target = _pc + 2 + static_cast<uint32_t>(static_cast<int8_t>(disp8));
+
+			switch ((op >> 8) & 0xf)
+			{
+			case 0:		return InstructionType::Branch;
+			case 1:		return InstructionType::Call;
+			default:	return InstructionType::ConditionalBranch;
+			}
+		}
+
+		return InstructionType::Normal;
+	}
+
+	void DisasmCache::sweep(Mc68k& _mc68k, const uint32_t _first, const uint32_t _end, const uint32_t _cpuType, std::vector<Entry>& _entries)
+	{
+		_entries.reserve((_end - _first) / 4);
+
+		for(uint32_t addr = _first; addr < _end;)
+		{
+			_entries.push_back(decode(_mc68k, addr, _cpuType));
+			addr += _entries.back().length;
+		}
+	}
+
+	DisasmCache::Entry DisasmCache::decode(Mc68k& _mc68k, const uint32_t _addr, const uint32_t _cpuType)
+	{
+		char disasm[64];
+		const auto opSize = _mc68k.disassemble(_addr, disasm);
+
+		Entry e{};
+		e.address = _addr;
+		e.length = static_cast<uint8_t>(std::max(opSize, 2u));
+
+		const uint16_t words[3] = {_mc68k.peek16(_addr), _mc68k.peek16(_addr + 2), _mc68k.peek16(_addr + 4)};
+
+		e.type = m68k_is_valid_instruction(words[0], _cpuType) ? getInstructionType(words, _addr, e.target) : InstructionType::Invalid;
+
+		if(e.type == InstructionType::Invalid)
+			e.target = InvalidTarget;
+
+		return e;
+	}
+
+	uint32_t DisasmCache::getThreadCount(const uint32_t _threadCount)
+	{
+		if(_threadCount)
+			return _threadCount;
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+}
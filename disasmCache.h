@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mc68k
+{
+	class Mc68k;
+
+	// Decoded instruction information of a code range (usually the ROM), built once via a linear sweep and shared by
+	// assembly dumps, profilers and debuggers
+	class DisasmCache
+	{
+	public:
+		enum class InstructionType : uint8_t
+		{
+			Invalid,
+			Normal,
+			Branch,				// bra
+			ConditionalBranch,	// bcc, dbcc
+			Call,				// bsr, jsr
+			Jump,				// jmp
+			Return,				// rts, rte, rtr, rtd
+		};
+
+		static constexpr uint32_t InvalidTarget = 0xffffffff;
+
+		struct Entry
+		{
+			uint32_t address;
+			uint32_t target;	// branch or call target if it can be determined statically, InvalidTarget otherwise
+			uint8_t length;		// in bytes
+			InstructionType type;
+		};
+
+		// _threadCount = 0 uses all available hardware threads
+		void build(Mc68k& _mc68k, uint32_t _first, uint32_t _count, uint32_t _threadCount = 1);
+		void clear();
+
+		bool isBuilt(const uint32_t _first, const uint32_t _count) const { return !m_entries.empty() && m_first == _first && m_count == _count; }
+		bool contains(const uint32_t _addr) const { return _addr >= m_first && _addr - m_first < m_count; }
+
+		// returns the instruction that starts at _addr or nullptr if no instruction starts there
+		const Entry* find(const uint32_t _addr) const
+		{
+			if(!contains(_addr))
+				return nullptr;
+			const auto idx = m_index[(_addr - m_first) >> 1];
+			return idx == InvalidIndex ? nullptr : &m_entries[idx];
+		}
+
+		const std::vector<Entry>& getEntries() const { return m_entries; }
+
+		bool dump(Mc68k& _mc68k, const std::string& _filename, bool _splitFunctions, uint32_t _threadCount = 1) const;
+
+		static InstructionType getInstructionType(const uint16_t* _words, uint32_t _pc, uint32_t& _target);
+		static Entry decode(Mc68k& _mc68k, uint32_t _addr, uint32_t _cpuType);
+
+	private:
+		static constexpr uint32_t InvalidIndex = 0xffffffff;
+
+		static void sweep(Mc68k& _mc68k, uint32_t _first, uint32_t _end, uint32_t _cpuType, std::vector<Entry>& _entries);
+		static uint32_t getThreadCount(uint32_t _threadCount);
+
+		uint32_t m_first = 0;
+		uint32_t m_count = 0;
+		std::vector<Entry> m_entries;
+		std::vector<uint32_t> m_index;	// one per 16 bit word, index into m_entries
+	};
+}
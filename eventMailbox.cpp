@@ -0,0 +1,136 @@
+#include "eventMailbox.h"
+
+#include <algorithm>
+
+#include "hdi08.h"
+#include "inputRecorder.h"
+#include "mc68k.h"
+#include "port.h"
+
+namespace mc68k
+{
+	EventMailbox::EventMailbox(Mc68k& _mc68k, const uint32_t _capacity/* = DefaultCapacity*/)
+	: m_mc68k(_mc68k)
+	, m_posted(_capacity)
+	{
+	}
+
+	bool EventMailbox::postInterrupt(const uint8_t _vector, const uint8_t _level, const uint64_t _cycle/* = Immediate*/)
+	{
+		return post({_cycle, _vector, 0, nullptr, nullptr, 0, EventType::Interrupt, _level, 0});
+	}
+
+	bool EventMailbox::postPortRx(Port& _port, const uint8_t _data, const uint64_t _cycle/* = Immediate*/)
+	{
+		return post({_cycle, _data, 0, &_port, nullptr, 0, EventType::PortRx, 0, 0});
+	}
+
+	bool EventMailbox::postPortPin(Port& _port, const uint8_t _bit, const bool _set, const uint64_t _cycle/* = Immediate*/)
+	{
+		return post({_cycle, 0, 0, &_port, nullptr, 0, EventType::PortPin, _bit, static_cast<uint8_t>(_set ? 1 : 0)});
+	}
+
+	bool EventMailbox::postHostEvent(const uint32_t _id, const uint64_t _data, const uint64_t _cycle/* = Immediate*/)
+	{
+		return post({_cycle, _data, 0, nullptr, nullptr, _id, EventType::Host, 0, 0});
+	}
+
+	bool EventMailbox::postSciRx(const uint16_t _data, const uint64_t _cycle/* = Immediate*/)
+	{
+		return post({_cycle, _data, 0, nullptr, nullptr, 0, EventType::SciRx, 0, 0});
+	}
+
+	bool EventMailbox::postHdiRx(Hdi08& _hdi, const uint32_t _word, const uint64_t _cycle/* = Immediate*/)
+	{
+		return post({_cycle, _word, 0, nullptr, &_hdi, 0, EventType::HdiRx, 0, 0});
+	}
+
+	void EventMailbox::process(const uint64_t _cycles)
+	{
+		const auto later = [](const Event& _a, const Event& _b)
+		{
+			return _a.cycle != _b.cycle ? _a.cycle > _b.cycle : _a.order > _b.order;
+		};
+
+		while(hasPosted())
+		{
+			auto e = m_posted.front();
+			m_posted.pop();
+
+			e.order = m_order++;
+
+			if(e.cycle <= _cycles && m_scheduled.empty())
+			{
+				apply(e);
+				continue;
+			}
+
+			// events that are due are applied below in cycle order together with the already scheduled ones
+			m_scheduled.push_back(e);
+			std::push_heap(m_scheduled.begin(), m_scheduled.end(), later);
+		}
+
+		while(!m_scheduled.empty() && m_scheduled.front().cycle <= _cycles)
+		{
+			std::pop_heap(m_scheduled.begin(), m_scheduled.end(), later);
+			const auto e = m_scheduled.back();
+			m_scheduled.pop_back();
+			apply(e);
+		}
+
+		m_nextScheduledCycle = m_scheduled.empty() ? std::numeric_limits<uint64_t>::max() : m_scheduled.front().cycle;
+	}
+
+	void EventMailbox::apply(const Event& _e) const
+	{
+		if(!record(_e))
+			return;
+
+		switch (_e.type)
+		{
+		case EventType::Interrupt:
+			m_mc68k.injectInterrupt(static_cast<uint8_t>(_e.data), _e.a);
+			break;
+		case EventType::PortRx:
+			_e.port->writeRX(static_cast<uint8_t>(_e.data));
+			break;
+		case EventType::PortPin:
+			if(_e.b)
+				_e.port->setBitRX(_e.a);
+			else
+				_e.port->clearBitRX(_e.a);
+			break;
+		case EventType::Host:
+			if(m_hostEventCallback)
+				m_hostEventCallback(_e.id, _e.data);
+			break;
+		case EventType::SciRx:
+			m_mc68k.getQSM().writeSciRX(static_cast<uint16_t>(_e.data), _e.cycle);
+			break;
+		case EventType::HdiRx:
+			_e.hdi->writeRx(static_cast<uint32_t>(_e.data));
+			break;
+		}
+	}
+
+	bool EventMailbox::record(const Event& _e) const
+	{
+		auto* recorder = m_mc68k.getInputRecorder();
+
+		if(!recorder)
+			return true;
+
+		using Type = InputRecorder::EventType;
+
+		switch (_e.type)
+		{
+		case EventType::Interrupt:	return recorder->onInput(Type::Interrupt, _e.a, _e.data);
+		case EventType::PortRx:		return recorder->onInput(Type::PortRx, recorder->getPortIndex(*_e.port), _e.data);
+		case EventType::PortPin:	return recorder->onInput(Type::PortPin, recorder->getPortIndex(*_e.port), _e.a, _e.b);
+		case EventType::Host:		return recorder->onInput(Type::Host, 0, _e.data, _e.id);
+		case EventType::SciRx:		return recorder->onInput(Type::SciRx, 0, _e.data, _e.cycle);
+		case EventType::HdiRx:		return recorder->onInput(Type::HdiRx, recorder->getHdi08Index(*_e.hdi), _e.data);
+		}
+		return true;
+	}
+}
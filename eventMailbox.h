@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "mpscQueue.h"
+
+namespace mc68k
+{
+	class Hdi08;
+	class Mc68k;
+	class Port;
+
+	// Lock-free mailbox that lets any number of host threads (MIDI, UI, DSP) pass interrupts, port input changes, SCI
+	// and HDI08 data and generic host events to the emulation thread. Mc68k drains it before each instruction. An event
+	// is applied as soon as possible or, if it carries a target cycle, at the first instruction boundary at or after
+	// that cycle, which makes the point at which it lands independent of host thread timing.
+	// If an InputRecorder is set, events are recorded when they are applied and dropped while inputs are replayed
+	class EventMailbox
+	{
+	public:
+		static constexpr uint64_t Immediate = 0;
+		static constexpr uint32_t DefaultCapacity = 1024;
+
+		using HostEventCallback = std::function<void(uint32_t _id, uint64_t _data)>;
+
+		explicit EventMailbox(Mc68k& _mc68k, uint32_t _capacity = DefaultCapacity);
+
+		// producer side, can be called from any thread. Returns false if the mailbox is full
+		bool postInterrupt(uint8_t _vector, uint8_t _level, uint64_t _cycle = Immediate);
+		bool postPortRx(Port& _port, uint8_t _data, uint64_t _cycle = Immediate);
+		bool postPortPin(Port& _port, uint8_t _bit, bool _set, uint64_t _cycle = Immediate);
+		bool postHostEvent(uint32_t _id, uint64_t _data, uint64_t _cycle = Immediate);
+
+		// SCI data is passed to Qsm::writeSciRX() with _cycle as its receive cycle
+		bool postSciRx(uint16_t _data, uint64_t _cycle = Immediate);
+		bool postHdiRx(Hdi08& _hdi, uint32_t _word, uint64_t _cycle = Immediate);
+
+		// called on the emulation thread for events posted with postHostEvent()
+		void setHostEventCallback(const HostEventCallback& _callback) { m_hostEventCallback = _callback; }
+		const HostEventCallback& getHostEventCallback() const { return m_hostEventCallback; }
+
+		// called by Mc68k on the emulation thread before each instruction
+		void exec(const uint64_t _cycles)
+		{
+			if(_cycles >= m_nextScheduledCycle || hasPosted())
+				process(_cycles);
+		}
+
+	private:
+		enum class EventType : uint8_t
+		{
+			Interrupt,
+			PortRx,
+			PortPin,
+			Host,
+			SciRx,
+			HdiRx
+		};
+
+		struct Event
+		{
+			uint64_t cycle;
+			uint64_t data;
+			uint64_t order;		// arrival order, keeps events with the same target cycle in sequence
+			Port* port;
+			Hdi08* hdi;
+			uint32_t id;
+			EventType type;
+			uint8_t a;			// interrupt level / pin
+			uint8_t b;			// pin state
+		};
+
+		bool post(const Event& _e) { return m_posted.push(_e); }
+		bool hasPosted() const { return !m_posted.empty(); }
+		void process(uint64_t _cycles);
+		void apply(const Event& _e) const;
+		bool record(const Event& _e) const;
+
+		Mc68k& m_mc68k;
+		HostEventCallback m_hostEventCallback;
+
+		MpscQueue<Event> m_posted;
+
+		// emulation thread only, min heap of events waiting for their target cycle
+		std::vector<Event> m_scheduled;
+		uint64_t m_nextScheduledCycle = std::numeric_limits<uint64_t>::max();
+		uint64_t m_order = 0;
+	};
+}
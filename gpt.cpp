@@ -140,6 +140,8 @@ namespace mc68k
 	{
 		PeripheralBase::exec(_deltaCycles);
 
+		m_portGP.exec(m_mc68k.getCycles());
+
 		if constexpr (g_tocCount > 0)	execToc<0>(_deltaCycles);
 		if constexpr (g_tocCount > 1)	execToc<1>(_deltaCycles);
 		if constexpr (g_tocCount > 2)	execToc<2>(_deltaCycles);
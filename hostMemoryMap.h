@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mc68k
+{
+	// Ranges of the 68k address space that are plain RAM or ROM, backed by host memory in 68k byte order. Fast paths such
+	// as burst transfers and the loop accelerator access them directly instead of calling the virtual read/write
+	// functions. The integrator needs to make sure that no peripheral is mapped into a registered range
+	class HostMemoryMap
+	{
+	public:
+		// read-only memory (ROM) is never written via the map
+		void add(const uint32_t _addr, const uint32_t _size, uint8_t* _hostMemory, const bool _writable)
+		{
+			m_regions.push_back({_addr, _size, _hostMemory, _writable});
+			++m_version;
+		}
+
+		void clear() { m_regions.clear(); ++m_version; }
+
+		// changes whenever regions are added or removed
+		uint32_t getVersion() const { return m_version; }
+		bool empty() const { return m_regions.empty(); }
+
+		// returns the host memory for [_addr, _addr + _size) if the range is within a single region, nullptr otherwise
+		uint8_t* find(const uint32_t _addr, const uint32_t _size, const bool _write) const
+		{
+			for (const auto& r : m_regions)
+			{
+				const auto offset = _addr - r.addr;
+
+				if(_addr < r.addr || offset > r.size || r.size - offset < _size)
+					continue;
+
+				return _write && !r.writable ? nullptr : r.hostMemory + offset;
+			}
+			return nullptr;
+		}
+
+	private:
+		struct Region
+		{
+			uint32_t addr;
+			uint32_t size;
+			uint8_t* hostMemory;
+			bool writable;
+		};
+
+		std::vector<Region> m_regions;
+		uint32_t m_version = 0;
+	};
+}
@@ -0,0 +1,206 @@
+#include "inputRecorder.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "hdi08.h"
+#include "logging.h"
+#include "mc68k.h"
+
+namespace mc68k
+{
+	namespace
+	{
+		constexpr char g_inputMagic[8] = {'M','6','8','K','I','N','P','2'};
+	}
+
+	InputRecorder::InputRecorder(Mc68k& _mc68k) : m_mc68k(_mc68k)
+	{
+	}
+
+	uint8_t InputRecorder::addHdi08(Hdi08& _hdi)
+	{
+		m_hdi08s.push_back(&_hdi);
+		return static_cast<uint8_t>(m_hdi08s.size() - 1);
+	}
+
+	void InputRecorder::writeHdiRx(const uint32_t _word, const uint8_t _hdiIndex/* = 0*/)
+	{
+		// while replaying, inputs are coming from the recording
+		if(m_mode == Mode::Replay)
+			return;
+
+		if(_hdiIndex >= m_hdi08s.size())
+		{
+			MCLOG("Invalid HDI08 index " << static_cast<int>(_hdiIndex));
+			return;
+		}
+
+		checkPosted(m_mc68k.getEventMailbox().postHdiRx(*m_hdi08s[_hdiIndex], _word));
+	}
+
+	void InputRecorder::writeSciRx(const uint16_t _data, const uint64_t _cycle/* = 0*/)
+	{
+		if(m_mode != Mode::Replay)
+			checkPosted(m_mc68k.getEventMailbox().postSciRx(_data, _cycle));
+	}
+
+	void InputRecorder::writePortRx(const PortId _port, const uint8_t _data)
+	{
+		if(m_mode != Mode::Replay)
+			checkPosted(m_mc68k.getEventMailbox().postPortRx(getPort(_port), _data));
+	}
+
+	void InputRecorder::injectInterrupt(const uint8_t _vector, const uint8_t _level)
+	{
+		if(m_mode != Mode::Replay)
+			checkPosted(m_mc68k.getEventMailbox().postInterrupt(_vector, _level));
+	}
+
+	void InputRecorder::startRecording()
+	{
+		m_events.clear();
+		m_replayIndex = 0;
+		m_mode = Mode::Record;
+	}
+
+	void InputRecorder::stopRecording()
+	{
+		if(m_mode == Mode::Record)
+			m_mode = Mode::Passthrough;
+	}
+
+	bool InputRecorder::startReplay(const std::string& _filename)
+	{
+		FILE* f = fopen(_filename.c_str(), "rb");
+
+		if(!f)
+			return false;
+
+		char magic[sizeof(g_inputMagic)];
+
+		if(fread(magic, sizeof(magic), 1, f) != 1 || memcmp(magic, g_inputMagic, sizeof(magic)) != 0)
+		{
+			MCLOG("Invalid input recording " << _filename);
+			fclose(f);
+			return false;
+		}
+
+		m_events.clear();
+
+		Event e{};
+		while(fread(&e, sizeof(e), 1, f) == 1)
+			m_events.push_back(e);
+
+		fclose(f);
+
+		MCLOG("Loaded " << m_events.size() << " input events for replay");
+
+		m_replayIndex = 0;
+		m_mode = Mode::Replay;
+
+		return true;
+	}
+
+	bool InputRecorder::save(const std::string& _filename) const
+	{
+		FILE* f = fopen(_filename.c_str(), "wb");
+
+		if(!f)
+			return false;
+
+		fwrite(g_inputMagic, sizeof(g_inputMagic), 1, f);
+		fwrite(m_events.data(), sizeof(Event), m_events.size(), f);
+		fclose(f);
+
+		return true;
+	}
+
+	bool InputRecorder::onInput(const EventType _type, const uint8_t _target, const uint64_t _data, const uint64_t _param/* = 0*/)
+	{
+		switch (m_mode.load())
+		{
+		case Mode::Record:
+			if(_target == InvalidTarget && (_type == EventType::HdiRx || _type == EventType::PortRx || _type == EventType::PortPin))
+				MCLOG("Input for an unknown HDI08 or port is not recorded");
+			else
+				m_events.push_back({m_mc68k.getCycles(), _data, _param, _type, _target, {}});
+			return true;
+		case Mode::Replay:
+			return false;
+		case Mode::Passthrough:
+		default:
+			return true;
+		}
+	}
+
+	uint8_t InputRecorder::getPortIndex(const Port& _port) const
+	{
+		for(uint8_t i=0; i<=static_cast<uint8_t>(PortId::QS); ++i)
+		{
+			if(&getPort(static_cast<PortId>(i)) == &_port)
+				return i;
+		}
+		return InvalidTarget;
+	}
+
+	uint8_t InputRecorder::getHdi08Index(const Hdi08& _hdi) const
+	{
+		for(size_t i=0; i<m_hdi08s.size(); ++i)
+		{
+			if(m_hdi08s[i] == &_hdi)
+				return static_cast<uint8_t>(i);
+		}
+		return InvalidTarget;
+	}
+
+	void InputRecorder::checkPosted(const bool _posted)
+	{
+		if(!_posted)
+			MCLOG("Event mailbox is full, input dropped");
+	}
+
+	void InputRecorder::apply(const Event& _e)
+	{
+		switch (_e.type)
+		{
+		case EventType::HdiRx:
+			if(_e.target < m_hdi08s.size())
+				m_hdi08s[_e.target]->writeRx(static_cast<uint32_t>(_e.data));
+			else
+				MCLOG("Invalid HDI08 index " << static_cast<int>(_e.target));
+			break;
+		case EventType::SciRx:
+			m_mc68k.getQSM().writeSciRX(static_cast<uint16_t>(_e.data), _e.param);
+			break;
+		case EventType::PortRx:
+			getPort(static_cast<PortId>(_e.target)).writeRX(static_cast<uint8_t>(_e.data));
+			break;
+		case EventType::Interrupt:
+			m_mc68k.injectInterrupt(static_cast<uint8_t>(_e.data), _e.target);
+			break;
+		case EventType::PortPin:
+			if(_e.param)
+				getPort(static_cast<PortId>(_e.target)).setBitRX(static_cast<uint32_t>(_e.data));
+			else
+				getPort(static_cast<PortId>(_e.target)).clearBitRX(static_cast<uint32_t>(_e.data));
+			break;
+		case EventType::Host:
+			if(const auto& callback = m_mc68k.getEventMailbox().getHostEventCallback())
+				callback(static_cast<uint32_t>(_e.param), _e.data);
+			break;
+		}
+	}
+
+	Port& InputRecorder::getPort(const PortId _port) const
+	{
+		switch (_port)
+		{
+		case PortId::E:		return m_mc68k.getPortE();
+		case PortId::F:		return m_mc68k.getPortF();
+		case PortId::GP:	return m_mc68k.getPortGP();
+		case PortId::QS:
+		default:			return m_mc68k.getPortQS();
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mc68k
+{
+	class Hdi08;
+	class Mc68k;
+	class Port;
+
+	// Records all external inputs together with the emulated cycle at which they were applied and is able to replay
+	// them at exactly the same cycles later on.
+	// Inputs from host threads are passed to the recorder or to the EventMailbox instead of directly to the
+	// peripherals. The recorder posts them to the mailbox, which applies them on the emulation thread at an instruction
+	// boundary and passes each one to onInput() first, which makes the cycle stamp exact. While replaying, host inputs
+	// are dropped and the recorded ones are applied instead.
+	// Start and stop recording and save on the emulation thread or while it is paused
+	class InputRecorder
+	{
+	public:
+		enum class Mode : uint8_t
+		{
+			Passthrough,
+			Record,
+			Replay
+		};
+
+		enum class EventType : uint8_t
+		{
+			HdiRx,
+			SciRx,
+			PortRx,
+			Interrupt,
+			PortPin,
+			Host
+		};
+
+		enum class PortId : uint8_t
+		{
+			E,
+			F,
+			GP,
+			QS
+		};
+
+		static constexpr uint8_t InvalidTarget = 0xff;
+
+		struct Event
+		{
+			uint64_t cycle;
+			uint64_t data;		// HDI word, SCI data, port data, pin, interrupt vector or host event data
+			uint64_t param;		// SCI receive cycle, pin state or host event id
+			EventType type;
+			uint8_t target;		// HDI08 index, PortId or interrupt level
+			uint8_t reserved[6];
+		};
+
+		static_assert(sizeof(Event) == 32, "event size must be 32 bytes");
+
+		explicit InputRecorder(Mc68k& _mc68k);
+
+		uint8_t addHdi08(Hdi08& _hdi);
+
+		// host facing inputs, can be called from any thread
+		void writeHdiRx(uint32_t _word, uint8_t _hdiIndex = 0);
+		void writeSciRx(uint16_t _data, uint64_t _cycle = 0);
+		void writePortRx(PortId _port, uint8_t _data);
+		void injectInterrupt(uint8_t _vector, uint8_t _level);
+
+		void startRecording();
+		void stopRecording();
+		bool startReplay(const std::string& _filename);
+
+		bool save(const std::string& _filename) const;
+
+		Mode getMode() const { return m_mode; }
+		const std::vector<Event>& getEvents() const { return m_events; }
+		bool isReplayFinished() const { return m_replayIndex >= m_events.size(); }
+
+		// called by Mc68k on the emulation thread before each instruction
+		void exec(const uint64_t _cycles)
+		{
+			if(m_mode != Mode::Replay)
+				return;
+
+			while(m_replayIndex < m_events.size() && m_events[m_replayIndex].cycle <= _cycles)
+				apply(m_events[m_replayIndex++]);
+		}
+
+		// Called by the EventMailbox on the emulation thread before it applies an input, records it while recording.
+		// Returns false while replaying, the input is dropped then
+		bool onInput(EventType _type, uint8_t _target, uint64_t _data, uint64_t _param = 0);
+
+		// target of an input for onInput(), InvalidTarget if it is unknown to the recorder
+		uint8_t getPortIndex(const Port& _port) const;
+		uint8_t getHdi08Index(const Hdi08& _hdi) const;
+
+	private:
+		static void checkPosted(bool _posted);
+		void apply(const Event& _e);
+		Port& getPort(PortId _port) const;
+
+		Mc68k& m_mc68k;
+		std::vector<Hdi08*> m_hdi08s;
+
+		std::atomic<Mode> m_mode = Mode::Passthrough;
+
+		std::vector<Event> m_events;
+		size_t m_replayIndex = 0;
+	};
+}
@@ -0,0 +1,130 @@
+#include "instructionFusion.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "cpuState.h"
+#include "logging.h"
+
+namespace mc68k
+{
+	namespace
+	{
+		constexpr char g_profileMagic[8] = {'M','6','8','K','F','U','S','1'};
+	}
+
+	InstructionFusion::InstructionFusion()
+	{
+		m_table.fill(0);
+	}
+
+	void InstructionFusion::startProfiling()
+	{
+		if(m_pairCounts.empty())
+			m_pairCounts.resize(0x10000, 0);
+
+		m_profiling = true;
+	}
+
+	void InstructionFusion::countPair(const uint16_t _first, const uint16_t _second)
+	{
+		if(isFusableBranch(_second))
+			++m_pairCounts[_first];
+	}
+
+	uint32_t InstructionFusion::buildTable(const float _coverage/* = 0.99f*/)
+	{
+		clearTable();
+
+		if(m_pairCounts.empty())
+			return 0;
+
+		std::vector<uint32_t> opcodes;
+		uint64_t total = 0;
+
+		for(uint32_t i=0; i<0x10000; ++i)
+		{
+			if(!m_pairCounts[i])
+				continue;
+			opcodes.push_back(i);
+			total += m_pairCounts[i];
+		}
+
+		std::sort(opcodes.begin(), opcodes.end(), [&](const uint32_t _a, const uint32_t _b)
+		{
+			return m_pairCounts[_a] > m_pairCounts[_b];
+		});
+
+		const auto required = static_cast<uint64_t>(static_cast<double>(total) * _coverage);
+		uint64_t covered = 0;
+
+		for (const auto op : opcodes)
+		{
+			if(covered >= required)
+				break;
+
+			m_table[op >> 3] |= static_cast<uint8_t>(1 << (op & 7));
+			covered += m_pairCounts[op];
+			++m_opcodeCount;
+		}
+
+		MCLOG("Instruction fusion table built, " << m_opcodeCount << " opcodes cover " << covered << " of " << total << " pairs");
+
+		return m_opcodeCount;
+	}
+
+	void InstructionFusion::clearTable()
+	{
+		m_table.fill(0);
+		m_opcodeCount = 0;
+	}
+
+	bool InstructionFusion::saveProfile(const std::string& _filename) const
+	{
+		if(m_pairCounts.empty())
+			return false;
+
+		FILE* f = fopen(_filename.c_str(), "wb");
+
+		if(!f)
+			return false;
+
+		fwrite(g_profileMagic, sizeof(g_profileMagic), 1, f);
+		fwrite(m_pairCounts.data(), sizeof(uint64_t), m_pairCounts.size(), f);
+		fclose(f);
+
+		return true;
+	}
+
+	bool InstructionFusion::loadProfile(const std::string& _filename)
+	{
+		FILE* f = fopen(_filename.c_str(), "rb");
+
+		if(!f)
+			return false;
+
+		char magic[sizeof(g_profileMagic)];
+		std::vector<uint64_t> counts(0x10000);
+
+		const bool valid = fread(magic, sizeof(magic), 1, f) == 1 && memcmp(magic, g_profileMagic, sizeof(magic)) == 0 &&
+			fread(counts.data(), sizeof(uint64_t), counts.size(), f) == counts.size();
+
+		fclose(f);
+
+		if(!valid)
+		{
+			MCLOG("Invalid instruction fusion profile " << _filename);
+			return false;
+		}
+
+		m_pairCounts.swap(counts);
+
+		return true;
+	}
+
+	bool InstructionFusion::isFusableBranch(const uint16_t _opcode)
+	{
+		return m68k_is_fusable_branch(_opcode) != 0;
+	}
+}
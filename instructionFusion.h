@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mc68k
+{
+	// Profile driven fusion of instruction pairs. While profiling, every instruction that is directly followed by a branch
+	// (BRA, Bcc, DBcc) is counted per opcode. The table built from the profile contains the opcodes that account for most
+	// of these pairs, the core then executes such an instruction and the following branch in one step.
+	// Profiling needs to be done with fusion disabled, otherwise fused pairs are not counted
+	class InstructionFusion
+	{
+	public:
+		using Table = std::array<uint8_t, 0x10000 / 8>;
+
+		InstructionFusion();
+
+		void startProfiling();
+		void stopProfiling() { m_profiling = false; }
+		bool isProfiling() const { return m_profiling; }
+
+		void countPair(uint16_t _first, uint16_t _second);
+
+		// selects the most frequently counted opcodes until they cover _coverage of all counted pairs. Returns the number
+		// of opcodes in the table
+		uint32_t buildTable(float _coverage = 0.99f);
+		void clearTable();
+
+		bool saveProfile(const std::string& _filename) const;
+		bool loadProfile(const std::string& _filename);
+
+		const Table& getTable() const { return m_table; }
+		uint32_t getOpcodeCount() const { return m_opcodeCount; }
+
+		static bool isFusableBranch(uint16_t _opcode);
+
+	private:
+		std::vector<uint64_t> m_pairCounts;	// per first opcode
+		Table m_table;
+		uint32_t m_opcodeCount = 0;
+		bool m_profiling = false;
+	};
+}
@@ -0,0 +1,99 @@
+#include "lockstepValidator.h"
+
+#include <sstream>
+
+#include "cpuState.h"
+#include "logging.h"
+#include "mc68k.h"
+
+namespace mc68k
+{
+	namespace
+	{
+		struct RegInfo
+		{
+			m68k_register_t reg;
+			const char* name;
+		};
+
+		constexpr RegInfo g_compareRegs[] =
+		{
+			{M68K_REG_D0, "D0"}, {M68K_REG_D1, "D1"}, {M68K_REG_D2, "D2"}, {M68K_REG_D3, "D3"},
+			{M68K_REG_D4, "D4"}, {M68K_REG_D5, "D5"}, {M68K_REG_D6, "D6"}, {M68K_REG_D7, "D7"},
+			{M68K_REG_A0, "A0"}, {M68K_REG_A1, "A1"}, {M68K_REG_A2, "A2"}, {M68K_REG_A3, "A3"},
+			{M68K_REG_A4, "A4"}, {M68K_REG_A5, "A5"}, {M68K_REG_A6, "A6"}, {M68K_REG_A7, "A7"},
+			{M68K_REG_PC, "PC"}, {M68K_REG_SR, "SR"}, {M68K_REG_USP, "USP"}, {M68K_REG_ISP, "ISP"},
+			{M68K_REG_MSP, "MSP"}, {M68K_REG_VBR, "VBR"}, {M68K_REG_CACR, "CACR"},
+		};
+	}
+
+	LockstepValidator::LockstepValidator(Mc68k& _reference, Mc68k& _candidate) : m_reference(_reference), m_candidate(_candidate)
+	{
+	}
+
+	bool LockstepValidator::step()
+	{
+		const auto pc = m_reference.getPC();
+
+		m_candidate.exec();
+
+		// the candidate stopped in front of a breakpoint without executing anything
+		if(m_candidate.getStopReason() == StopReason::Breakpoint)
+			return true;
+
+		// the candidate may execute several instructions in one step (fusion, fast paths), let the reference catch up
+		while(m_reference.getCycles() < m_candidate.getCycles())
+			m_reference.exec();
+
+		++m_instructionCount;
+
+		return compare(pc);
+	}
+
+	uint64_t LockstepValidator::run(const uint64_t _count)
+	{
+		for(uint64_t i=0; i<_count; ++i)
+		{
+			if(!step())
+			{
+				MCLOG("Lockstep mismatch after " << m_instructionCount << " instructions: " << m_mismatch);
+				return i;
+			}
+		}
+		return _count;
+	}
+
+	bool LockstepValidator::compare(const uint32_t _pc)
+	{
+		std::stringstream ss;
+
+		for (const auto& r : g_compareRegs)
+		{
+			const auto ref = m68k_get_reg(m_reference.getCpuState(), r.reg);
+			const auto can = m68k_get_reg(m_candidate.getCpuState(), r.reg);
+
+			if(ref != can)
+				ss << ' ' << r.name << " expected " << MCHEX(ref) << " but got " << MCHEX(can);
+		}
+
+		if(m_reference.getCycles() != m_candidate.getCycles())
+			ss << " cycles expected " << std::dec << m_reference.getCycles() << " but got " << m_candidate.getCycles();
+
+		std::string memoryMismatch;
+
+		if(m_compareMemory && !m_compareMemory(memoryMismatch))
+			ss << ' ' << memoryMismatch;
+
+		if(ss.tellp() == 0)
+			return true;
+
+		char disasm[64];
+		m_reference.disassemble(_pc, disasm);
+
+		std::stringstream msg;
+		msg << "PC " << MCHEXN(_pc, 6) << " '" << disasm << "':" << ss.str();
+		m_mismatch = msg.str();
+
+		return false;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace mc68k
+{
+	class Mc68k;
+
+	// Runs two cores in lockstep and compares their state after every instruction. The reference core uses the plain
+	// interpreter, the candidate an alternative execution path (code memory, fused handlers, fast paths, ...). Both
+	// need to have been set up with identical memory contents and been reset
+	class LockstepValidator
+	{
+	public:
+		using CompareMemoryCallback = std::function<bool(std::string&)>;
+
+		LockstepValidator(Mc68k& _reference, Mc68k& _candidate);
+
+		// optional, called after every instruction, returns false and a description if memory differs
+		void setCompareMemoryCallback(const CompareMemoryCallback& _callback) { m_compareMemory = _callback; }
+
+		// executes one instruction on both cores, returns false on a mismatch. If the candidate stops at a breakpoint,
+		// the reference is not stepped either
+		bool step();
+
+		// returns the number of instructions executed before a mismatch was found, _count if there was none
+		uint64_t run(uint64_t _count);
+
+		const std::string& getMismatch() const { return m_mismatch; }
+		uint64_t getInstructionCount() const { return m_instructionCount; }
+
+	private:
+		bool compare(uint32_t _pc);
+
+		Mc68k& m_reference;
+		Mc68k& m_candidate;
+		CompareMemoryCallback m_compareMemory;
+		std::string m_mismatch;
+		uint64_t m_instructionCount = 0;
+	};
+}
@@ -0,0 +1,142 @@
+#include "loopAccelerator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "cpuState.h"
+#include "mc68k.h"
+
+namespace mc68k
+{
+	namespace
+	{
+		constexpr uint16_t g_dbraDisplacement = 0xfffc;	// back to the single word instruction in front of the dbra
+
+		uint32_t getCopySize(const uint16_t _opcode)
+		{
+			switch (_opcode & 0xf1f8)
+			{
+			case 0x10d8:	return 1;	// move.b (Ay)+,(Ax)+
+			case 0x30d8:	return 2;	// move.w (Ay)+,(Ax)+
+			case 0x20d8:	return 4;	// move.l (Ay)+,(Ax)+
+			default:		return 0;
+			}
+		}
+
+		uint32_t getClearSize(const uint16_t _opcode)
+		{
+			switch (_opcode & 0xfff8)
+			{
+			case 0x4218:	return 1;	// clr.b (Ax)+
+			case 0x4258:	return 2;	// clr.w (Ax)+
+			case 0x4298:	return 4;	// clr.l (Ax)+
+			default:		return 0;
+			}
+		}
+
+		uint32_t readBigEndian(const uint8_t* _p, const uint32_t _size)
+		{
+			uint32_t v = 0;
+			for(uint32_t i=0; i<_size; ++i)
+				v = (v << 8) | _p[i];
+			return v;
+		}
+	}
+
+	uint32_t LoopAccelerator::exec(Mc68k& _mc68k)
+	{
+		auto& cpu = *_mc68k.getCpuState();
+		const auto& memoryMap = _mc68k.getHostMemoryMap();
+
+		const auto pc = cpu.pc;
+		const auto dbra = static_cast<uint16_t>(cpu.ir);
+
+		if(_mc68k.readImm16(pc + 2) != dbra || _mc68k.readImm16(pc + 4) != g_dbraDisplacement)
+			return 0;
+
+		const auto opcode = _mc68k.readImm16(pc);
+
+		const auto copySize = getCopySize(opcode);
+		const auto clearSize = copySize ? 0 : getClearSize(opcode);
+		const auto size = copySize | clearSize;
+
+		if(!size)
+			return 0;
+
+		const auto dstReg = copySize ? 8 + ((opcode >> 9) & 7) : 8 + (opcode & 7);
+		const auto srcReg = 8 + (opcode & 7);
+
+		// byte accesses via (a7)+ increment by two, using the same register twice interleaves the accesses
+		if(size == 1 && (dstReg == 15 || (copySize && srcReg == 15)))
+			return 0;
+		if(copySize && dstReg == srcReg)
+			return 0;
+
+		auto& counter = cpu.dar[dbra & 7];
+
+		// the dbra has been executed already and branched back, the loop body runs counter + 1 more times
+		const uint32_t remaining = (counter & 0xffff) + 1;
+		const uint32_t iterations = std::min(remaining, m_maxIterations);
+		const uint32_t byteCount = iterations * size;
+
+		const auto dstAddr = cpu.dar[dstReg];
+		auto* dst = memoryMap.find(dstAddr, byteCount, true);
+
+		if(!dst)
+			return 0;
+
+		uint32_t lastValue = 0;
+
+		if(copySize)
+		{
+			const auto srcAddr = cpu.dar[srcReg];
+
+			// a forward copy into an overlapping range behind the source replicates data, memmove does not
+			if(dstAddr > srcAddr && dstAddr - srcAddr < byteCount)
+				return 0;
+
+			const auto* src = memoryMap.find(srcAddr, byteCount, false);
+
+			if(!src)
+				return 0;
+
+			memmove(dst, src, byteCount);
+			lastValue = readBigEndian(dst + byteCount - size, size);
+
+			cpu.dar[srcReg] = srcAddr + byteCount;
+		}
+		else
+		{
+			memset(dst, 0, byteCount);
+		}
+
+		cpu.dar[dstReg] = dstAddr + byteCount;
+
+		// move and clr set N and Z from the last value, clear V and C, X is unaffected
+		cpu.n_flag = lastValue >> ((size - 1) << 3);
+		cpu.not_z_flag = lastValue;
+		cpu.v_flag = 0;
+		cpu.c_flag = 0;
+
+		const auto bodyCycles = static_cast<int>(m68k_get_instruction_cycles(&cpu, opcode));
+		const auto dbraCycles = static_cast<int>(m68k_get_instruction_cycles(&cpu, dbra));
+
+		int cycles = static_cast<int>(iterations) * (bodyCycles + dbraCycles + static_cast<int>(cpu.cyc_dbcc_f_noexp));
+
+		if(iterations == remaining)
+		{
+			// the last dbra falls through
+			counter |= 0xffff;
+			cpu.pc = pc + 6;
+			cycles += static_cast<int>(cpu.cyc_dbcc_f_exp) - static_cast<int>(cpu.cyc_dbcc_f_noexp);
+		}
+		else
+		{
+			counter = (counter & 0xffff0000) | ((counter - iterations) & 0xffff);
+		}
+
+		cpu.ppc = cpu.pc;
+
+		return static_cast<uint32_t>(cycles);
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mc68k
+{
+	class Mc68k;
+
+	// Executes DBF copy and clear loops such as
+	//		loop:	move.b (a0)+,(a1)+		or		clr.l (a0)+
+	//				dbra d0,loop
+	// as host memory copies if source and destination are in the host memory map of the Mc68k. Registers, flags and
+	// cycles are updated as if the loop had been interpreted
+	class LoopAccelerator
+	{
+	public:
+		// iterations done per call of exec(), limits the delay of interrupts and peripheral updates
+		static constexpr uint32_t DefaultMaxIterations = 256;
+
+		void setMaxIterations(const uint32_t _count) { m_maxIterations = _count ? _count : 1; }
+
+		// called after a DBF has been executed. If it branched back to a supported loop body, runs further iterations
+		// and returns the cycles used, returns 0 otherwise
+		uint32_t exec(Mc68k& _mc68k);
+
+	private:
+		uint32_t m_maxIterations = DefaultMaxIterations;
+	};
+}
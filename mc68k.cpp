@@ -1,17 +1,17 @@
 #include "mc68k.h"
 
 #include <cassert>
-#include <atomic>
-#include <fstream>
-#include <cstring>	// strstr
 
 #include "logging.h"
 
 #include "cpuState.h"
+#include "inputRecorder.h"
+#include "traceRecorder.h"
 
 namespace
 {
-	std::atomic<mc68k::Mc68k*> g_instance = nullptr;
+	// instance that is disassembled on this thread, see Mc68k::disassemble()
+	thread_local mc68k::Mc68k* t_disasmInstance = nullptr;
 
 	mc68k::Mc68k* getInstance(m68ki_cpu_core* _core)
 	{
@@ -27,41 +27,55 @@ extern "C"
 	}
 	int m68k_illegal_cbk(m68ki_cpu_core* core, int opcode)
 	{
-		return static_cast<int>(getInstance(core)->onIllegalInstruction(static_cast<uint32_t>(opcode)));
+		auto* instance = getInstance(core);
+		if(instance->execBreakpoint(static_cast<uint32_t>(opcode)) || instance->execHleHook(static_cast<uint32_t>(opcode)))
+			return 1;
+		return static_cast<int>(instance->onIllegalInstruction(static_cast<uint32_t>(opcode)));
 	}
 	void m68k_reset_cbk(m68ki_cpu_core* core)
 	{
 		return getInstance(core)->onReset();
 	}
+	void m68k_instr_hook_cbk(m68ki_cpu_core* core, unsigned int pc)
+	{
+		auto* instance = getInstance(core);
+
+		// the instruction is recorded before its memory accesses
+		auto* trace = instance->getTraceRecorder();
+		if(trace && trace->isRunning())
+			trace->addInstruction(pc, instance->peek16(pc), instance->getCycles());
+
+		if(const auto& hook = instance->getInstructionHook())
+			hook(pc);
+	}
+	void m68k_pc_changed_cbk(m68ki_cpu_core* core, unsigned int new_pc)
+	{
+		getInstance(core)->getPcChangedHook()(new_pc);
+	}
 
 	unsigned int m68k_read_disassembler_8  (unsigned int address)
 	{
-		mc68k::Mc68k* instance = g_instance;
-		return m68k_read_memory_8(instance->getCpuState(), address);
+		return t_disasmInstance ? (t_disasmInstance->peek16(address & ~1u) >> ((address & 1) ? 0 : 8)) & 0xff : 0;
 	}
 	unsigned int m68k_read_disassembler_16 (unsigned int address)
 	{
-		mc68k::Mc68k* instance = g_instance;
-		return m68k_read_memory_16(instance->getCpuState(), address);
+		return t_disasmInstance ? t_disasmInstance->peek16(address) : 0;
 	}
 	unsigned int m68k_read_disassembler_32 (unsigned int address)
 	{
-		mc68k::Mc68k* instance = g_instance;
-		return m68k_read_memory_32(instance->getCpuState(), address);
+		return t_disasmInstance ? t_disasmInstance->peek32(address) : 0;
 	}
 }
 
 namespace mc68k
 {
-	Mc68k::Mc68k() : m_gpt(*this), m_sim(*this), m_qsm(*this)
+	Mc68k::Mc68k() : m_gpt(*this), m_sim(*this), m_qsm(*this), m_eventMailbox(*this)
 	{
 		m_cpuStateBuf.fill(0);
 
 		static_assert(sizeof(CpuState) <= CpuStateSize);
 		m_cpuState = reinterpret_cast<CpuState*>(m_cpuStateBuf.data());
 
-		g_instance = this;
-
 		getCpuState()->instance = this;
 
 		m68k_set_cpu_type(getCpuState(), M68K_CPU_TYPE_68020);
@@ -69,16 +83,66 @@ namespace mc68k
 		m68k_set_int_ack_callback(getCpuState(), m68k_int_ack);
 		m68k_set_illg_instr_callback(getCpuState(), m68k_illegal_cbk);
 		m68k_set_reset_instr_callback(getCpuState(), m68k_reset_cbk);
+		m68k_set_instr_hook_callback(getCpuState(), m68k_instr_hook_cbk);
+		m68k_set_pc_changed_callback(getCpuState(), m68k_pc_changed_cbk);
 	}
-	Mc68k::~Mc68k()
-	{
-		auto* inst = this;
-		g_instance.compare_exchange_strong(inst, nullptr);
-	};
+	Mc68k::~Mc68k() = default;
 
 	uint32_t Mc68k::exec()
 	{
-		const auto deltaCycles = m68k_execute(getCpuState(), 1);
+		m_stopReason = StopReason::None;
+
+		if(m_inputRecorder)
+			m_inputRecorder->exec(m_cycles);
+
+		m_eventMailbox.exec(m_cycles);
+
+		// step over the breakpoint that we stopped at, it is patched in again afterwards
+		m_steppingBreakpoint = m_resumeBreakpoint;
+
+		if(m_steppingBreakpoint)
+		{
+			m_resumeBreakpoint = false;
+			patchCode(m_breakpointAddr, m_hleHooks.find(m_breakpointAddr) != m_hleHooks.end());
+		}
+
+#if MC68K_SINGLE_INSTRUCTION_DISPATCH
+		auto deltaCycles = static_cast<uint32_t>(isInstrumented() ? m68k_execute_instruction_instrumented(getCpuState()) : m68k_execute_instruction(getCpuState()));
+#else
+		auto deltaCycles = static_cast<uint32_t>(isInstrumented() ? m68k_execute_instrumented(getCpuState(), 1) : m68k_execute(getCpuState(), 1));
+#endif
+
+		if(m_steppingBreakpoint)
+		{
+			m_steppingBreakpoint = false;
+			if(m_breakpoints.find(m_breakpointAddr) != m_breakpoints.end())
+				patchCode(m_breakpointAddr, true);
+		}
+
+		if(m_stopReason == StopReason::Breakpoint)
+		{
+			// the instruction has not been executed, it is recorded again when execution resumes
+			if(m_traceRecorder && m_traceRecorder->isRunning())
+				m_traceRecorder->removeLastInstruction();
+			return 0;
+		}
+
+		if(m_fusion.isProfiling())
+		{
+			// an exception or a watchpoint hit separates the instruction from its predecessor or successor
+			const auto opcode = static_cast<uint16_t>(getCpuState()->ir);
+			const bool separated = m68k_get_fusion_break(getCpuState()) != 0;
+			if(m_lastOpcodeValid && !separated)
+				m_fusion.countPair(m_lastOpcode, opcode);
+			m_lastOpcode = opcode;
+			m_lastOpcodeValid = !separated;
+		}
+
+		// dbf. Iterations run by the accelerator bypass hooks, breakpoints and watchpoints
+		if((getCpuState()->ir & 0xfff8) == 0x51c8 && !m_hostMemory.empty() && !isInstrumented() && !m_pcChangedHook &&
+			m_watchpoints.empty() && m_breakpoints.empty() && m_hleHooks.empty())
+			deltaCycles += m_loopAccelerator.exec(*this);
+
 		m_cycles += deltaCycles;
 
 		m_gpt.exec(deltaCycles);
@@ -111,6 +175,70 @@ namespace mc68k
 		return 0;
 	}
 
+	StopReason Mc68k::run(const uint64_t _cycles)
+	{
+		uint64_t cycles = 0;
+
+		while(cycles < _cycles)
+		{
+			cycles += exec();
+
+			if(m_stopReason != StopReason::None)
+				break;
+		}
+
+		return m_stopReason;
+	}
+
+	bool Mc68k::execBreakpoint(const uint32_t _opcode)
+	{
+		if(_opcode != PatchOpcode || m_breakpoints.empty())
+			return false;
+
+		auto* cpu = getCpuState();
+
+		if(m_steppingBreakpoint && cpu->ppc == m_breakpointAddr)
+			return false;
+
+		if(m_breakpoints.find(cpu->ppc) == m_breakpoints.end())
+			return false;
+
+		// undo the instruction, exec() returns without executing anything
+		cpu->pc = cpu->ppc;
+		cpu->m68ki_remaining_cycles += static_cast<int>(m68k_get_instruction_cycles(cpu, PatchOpcode));
+
+		m_stopReason = StopReason::Breakpoint;
+		m_resumeBreakpoint = true;
+		m_breakpointAddr = cpu->ppc;
+
+		return true;
+	}
+
+	bool Mc68k::execHleHook(const uint32_t _opcode)
+	{
+		if(_opcode != PatchOpcode || m_hleHooks.empty())
+			return false;
+
+		auto* cpu = getCpuState();
+
+		const auto it = m_hleHooks.find(cpu->ppc);
+
+		if(it == m_hleHooks.end())
+			return false;
+
+		const auto cycles = it->second(*this);
+
+		// return to the caller, as the rts at the end of the replaced routine would have done
+		const auto sp = getAReg(7);
+		setPC(m68k_read_memory_32(cpu, sp));
+		setAReg(7, sp + 4);
+
+		// the cycles of the illegal opcode itself have been accounted for by the core already
+		cpu->m68ki_remaining_cycles -= static_cast<int>(cycles) - static_cast<int>(m68k_get_instruction_cycles(cpu, PatchOpcode));
+
+		return true;
+	}
+
 	uint32_t Mc68k::readIrqUserVector(const uint8_t _level)
 	{
 		auto& vecs = m_pendingInterrupts[_level];
@@ -152,9 +280,179 @@ namespace mc68k
 		return m68k_get_reg(getCpuState(), static_cast<m68k_register_t>(M68K_REG_D0 + _index));
 	}
 
+	void Mc68k::setAReg(const uint32_t _index, const uint32_t _value)
+	{
+		m68k_set_reg(getCpuState(), static_cast<m68k_register_t>(M68K_REG_A0 + _index), _value);
+	}
+
+	void Mc68k::setDReg(const uint32_t _index, const uint32_t _value)
+	{
+		m68k_set_reg(getCpuState(), static_cast<m68k_register_t>(M68K_REG_D0 + _index), _value);
+	}
+
 	uint32_t Mc68k::disassemble(uint32_t _pc, char* _buffer)
 	{
-		return m68k_disassemble(_buffer, _pc, m68k_get_reg(getCpuState(), M68K_REG_CPU_TYPE));
+		auto* prev = t_disasmInstance;
+		t_disasmInstance = this;
+		const auto size = m68k_disassemble(_buffer, _pc, m68k_get_reg(getCpuState(), M68K_REG_CPU_TYPE));
+		t_disasmInstance = prev;
+		return size;
+	}
+
+	uint16_t Mc68k::peek16(const uint32_t _addr)
+	{
+		if(m_codeMemory && _addr >= m_codeAddr && _addr - m_codeAddr < m_codeSize && m_codeSize - (_addr - m_codeAddr) >= 2)
+			return memoryOps::readU16(m_codeMemory, _addr - m_codeAddr);
+
+		if(const auto* mem = m_hostMemory.find(_addr, 2, false))
+			return memoryOps::readU16(mem, 0);
+
+		return readImm16(_addr);
+	}
+
+	bool Mc68k::isPeekDirect(const uint32_t _addr, const uint32_t _size) const
+	{
+		if(m_codeMemory && _addr >= m_codeAddr && _addr - m_codeAddr <= m_codeSize && m_codeSize - (_addr - m_codeAddr) >= _size)
+			return true;
+
+		return m_hostMemory.find(_addr, _size, false) != nullptr;
+	}
+
+	void Mc68k::setCodeMemory(const uint32_t _addr, const uint32_t _size, const uint8_t* _hostMemory)
+	{
+		m_codeMemory = _hostMemory;
+		m_codeAddr = _addr;
+		m_codeSize = _hostMemory ? _size : 0;
+
+		m_disasmCache.clear();
+		updateCodeMemory();
+	}
+
+	bool Mc68k::addHleHook(const uint32_t _addr, HleHook _hook)
+	{
+		if(_addr - m_codeAddr >= m_codeSize || m_codeSize - (_addr - m_codeAddr) < 2)
+		{
+			MCLOG("HLE hook at " << MCHEX(_addr) << " is outside of the code memory");
+			return false;
+		}
+
+		m_hleHooks[_addr] = std::move(_hook);
+		updateCodeMemory();
+		return true;
+	}
+
+	void Mc68k::removeHleHook(const uint32_t _addr)
+	{
+		if(m_hleHooks.erase(_addr))
+			updateCodeMemory();
+	}
+
+	void Mc68k::clearHleHooks()
+	{
+		m_hleHooks.clear();
+		updateCodeMemory();
+	}
+
+	bool Mc68k::addBreakpoint(const uint32_t _addr)
+	{
+		if(_addr - m_codeAddr >= m_codeSize || m_codeSize - (_addr - m_codeAddr) < 2)
+		{
+			MCLOG("Breakpoint at " << MCHEX(_addr) << " is outside of the code memory");
+			return false;
+		}
+
+		m_breakpoints.insert(_addr);
+		updateCodeMemory();
+		return true;
+	}
+
+	void Mc68k::removeBreakpoint(const uint32_t _addr)
+	{
+		if(m_breakpoints.erase(_addr))
+			updateCodeMemory();
+	}
+
+	void Mc68k::clearBreakpoints()
+	{
+		m_breakpoints.clear();
+		updateCodeMemory();
+	}
+
+	void Mc68k::updateCodeMemory()
+	{
+		if(m_hleHooks.empty() && m_breakpoints.empty())
+		{
+			m_patchedCode.clear();
+			m68k_set_code_memory(getCpuState(), m_codeAddr, m_codeSize, m_codeMemory);
+			return;
+		}
+
+		m_patchedCode.assign(m_codeMemory, m_codeMemory + m_codeSize);
+
+		for (const auto addr : m_breakpoints)
+			patchCode(addr, !(m_steppingBreakpoint && addr == m_breakpointAddr));
+
+		for (const auto& it : m_hleHooks)
+			patchCode(it.first, true);
+
+		m68k_set_code_memory(getCpuState(), m_codeAddr, m_codeSize, m_patchedCode.data());
+	}
+
+	void Mc68k::patchCode(const uint32_t _addr, const bool _patch)
+	{
+		const auto offset = _addr - m_codeAddr;
+
+		if(m_patchedCode.empty() || offset >= m_codeSize || m_codeSize - offset < 2)
+			return;
+
+		memoryOps::writeU16(m_patchedCode.data(), offset, _patch ? PatchOpcode : memoryOps::readU16(m_codeMemory, offset));
+	}
+
+	void Mc68k::setFusionEnabled(const bool _enabled)
+	{
+		m_fusionEnabled = _enabled;
+		updateFusion();
+	}
+
+	void Mc68k::setFpuEnabled(const bool _enabled)
+	{
+		m68k_set_fpu_enabled(getCpuState(), _enabled ? 1 : 0);
+	}
+
+	bool Mc68k::isFpuEnabled() const
+	{
+		return getCpuState()->has_fpu != 0;
+	}
+
+	void Mc68k::setHostFpuEnabled(const bool _enabled)
+	{
+		if(_enabled && !isFpuEnabled() && m68k_get_reg(getCpuState(), M68K_REG_CPU_TYPE) != M68K_CPU_TYPE_68040)
+			MCLOG("Host FPU mode has no effect, the FPU is not enabled");
+
+		m68k_set_fpu_host_double(getCpuState(), _enabled ? 1 : 0);
+	}
+
+	bool Mc68k::isHostFpuEnabled() const
+	{
+		return getCpuState()->fpu_host_double != 0;
+	}
+
+	void Mc68k::setInstructionHook(InstructionHook _hook)
+	{
+		m_instructionHook = std::move(_hook);
+	}
+
+	void Mc68k::setPcChangedHook(PcChangedHook _hook)
+	{
+		m_pcChangedHook = std::move(_hook);
+		m68k_set_monitor_pc(getCpuState(), m_pcChangedHook ? 1 : 0);
+	}
+
+	void Mc68k::updateFusion()
+	{
+		// the trace recorder sees a fused pair as one instruction and would miss the first one
+		const bool active = m_fusionEnabled && !m_traceRecorder;
+		m68k_set_fusion_table(getCpuState(), active ? m_fusion.getTable().data() : nullptr);
 	}
 
 	CpuState* Mc68k::getCpuState()
@@ -167,33 +465,27 @@ namespace mc68k
 		return m_cpuState;
 	}
 
-	bool Mc68k::dumpAssembly(const std::string& _filename, uint32_t _first, uint32_t _count, bool _splitFunctions/* = true*/)
+	bool Mc68k::dumpAssembly(const std::string& _filename, const uint32_t _first, const uint32_t _count, const bool _splitFunctions/* = true*/, const uint32_t _threadCount/* = 1*/)
 	{
-		std::ofstream f(_filename, std::ios::out);
+		// the cache is stale if memory has been mapped differently since it has been built
+		if(m_disasmMemoryVersion != m_hostMemory.getVersion())
+		{
+			m_disasmCache.clear();
+			m_disasmMemoryVersion = m_hostMemory.getVersion();
+		}
 
-		if(!f.is_open())
-			return false;
+		if(!m_disasmCache.isBuilt(_first, _count))
+			m_disasmCache.build(*this, _first, _count, _threadCount);
 
-		for(uint32_t i=_first; i<_first + _count;)
-		{
-			char disasm[64];
-			const auto opSize = disassemble(i, disasm);
-			f << MCHEXN(i,6) << ": " << disasm << '\n';
-			if(!opSize)
-				++i;
-			else
-				i += opSize;
-
-			auto startsWith = [&](const char* _search)
-			{
-				return strstr(disasm, _search) == disasm;
-			};
+		return m_disasmCache.dump(*this, _filename, _splitFunctions, _threadCount);
+	}
 
-			if(startsWith("rts") || startsWith("bra ") || startsWith("jmp "))
-				f << '\n';
-		}
-		f.close();
-		return true;
+	void Mc68k::onWatchpointHit()
+	{
+		m_stopReason = StopReason::Watchpoint;
+
+		// the instruction completes but a following branch is executed on its own so that exec() stops right after it
+		m68k_break_fusion(getCpuState());
 	}
 
 	void Mc68k::raiseIPL()
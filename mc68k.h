@@ -1,33 +1,77 @@
 #pragma once
 
 #include <array>
+#include <functional>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
+#include "disasmCache.h"
 #include "endian.h"
+#include "eventMailbox.h"
 #include "gpt.h"
+#include "hostMemoryMap.h"
+#include "instructionFusion.h"
+#include "loopAccelerator.h"
 #include "qsm.h"
 #include "sim.h"
+#include "watchpointMap.h"
 
 namespace mc68k
 {
 	struct CpuState;
+	class InputRecorder;
+	class TraceRecorder;
+
+	enum class StopReason : uint8_t
+	{
+		None,
+		Breakpoint,
+		Watchpoint
+	};
 
 	class Mc68k
 	{
 	public:
-		static constexpr uint32_t CpuStateSize = 600;
+		static constexpr uint32_t CpuStateSize = 704;
+
+		// Opcode that is patched into the code memory at the address of a HLE hook or breakpoint (ILLEGAL)
+		static constexpr uint16_t PatchOpcode = 0x4afc;
+
+		// Native replacement of a firmware routine. Called when execution reaches the first instruction of the routine,
+		// with the return address on the stack. Returns the cycles that the routine would have used, Mc68k then returns
+		// to the caller
+		using HleHook = std::function<uint32_t(Mc68k&)>;
+
+		// Diagnostics callbacks, called with the PC before each instruction / with the new PC after a jump
+		using InstructionHook = std::function<void(uint32_t)>;
+		using PcChangedHook = std::function<void(uint32_t)>;
 
 		Mc68k();
 		virtual ~Mc68k();
 
 		virtual uint32_t exec();
 
+		// emulation thread only, other threads use getEventMailbox().postInterrupt()
 		void injectInterrupt(uint8_t _vector, uint8_t _level);
 		bool hasPendingInterrupt(uint8_t _vector, uint8_t _level) const;
 
 		virtual void onReset() {}
 		virtual uint32_t onIllegalInstruction(uint32_t _opcode);
 
+		// called by the core for illegal instructions before onIllegalInstruction(), return true if the opcode was a
+		// breakpoint / HLE hook
+		bool execBreakpoint(uint32_t _opcode);
+		bool execHleHook(uint32_t _opcode);
+
+		// called for data accesses to a page that contains a watchpoint
+		void onWatchedAccess(const uint32_t _addr, const uint32_t _size, const uint32_t _value, const bool _write)
+		{
+			if(m_watchpoints.check(_addr, _size, _value, _write))
+				onWatchpointHit();
+		}
+
 		virtual uint8_t read8(const uint32_t _addr)
 		{
 			const auto addr = static_cast<PeriphAddress>(_addr & g_peripheralMask);
@@ -79,12 +123,53 @@ namespace mc68k
 		
 		uint32_t getAReg(uint32_t _index) const;
 		uint32_t getDReg(uint32_t _index) const;
+		void setAReg(uint32_t _index, uint32_t _value);
+		void setDReg(uint32_t _index, uint32_t _value);
 
 		virtual uint32_t getResetPC() { return 0; }
 		virtual uint32_t getResetSP() { return 0; }
 
 		uint32_t disassemble(uint32_t _pc, char* _buffer);
 
+		// Reads code for the disassembler and analysis tools without side effects: no watchpoint checks, no trace
+		// records and no patched opcodes. The original code memory and the host memory map are read directly, other
+		// addresses fall back to readImm16. isPeekDirect() returns true if a range is read directly, which is safe
+		// from other threads
+		uint16_t peek16(uint32_t _addr);
+		uint32_t peek32(uint32_t _addr) { return static_cast<uint32_t>(peek16(_addr)) << 16 | peek16(_addr + 2); }
+		bool isPeekDirect(uint32_t _addr, uint32_t _size) const;
+
+		// Opcodes and extension words within [_addr, _addr + _size) are fetched directly from _hostMemory (68k byte
+		// order, as in a ROM image) instead of via readImm16. The memory needs to stay valid until the region is reset
+		void setCodeMemory(uint32_t _addr, uint32_t _size, const uint8_t* _hostMemory);
+		void clearCodeMemory() { setCodeMemory(0, 0, nullptr); }
+
+		// HLE hooks are executed via an illegal opcode that is patched into a copy of the code memory, _addr needs to be
+		// within the range passed to setCodeMemory(). The copy is taken when hooks change or the code memory is set, set
+		// the code memory again if its content has been modified later. Returns false if _addr is not in code memory
+		bool addHleHook(uint32_t _addr, HleHook _hook);
+		void removeHleHook(uint32_t _addr);
+		void clearHleHooks();
+
+		// Breakpoints are patched into the code memory the same way as HLE hooks, code without breakpoints runs at full
+		// speed. exec() stops in front of the instruction at a breakpoint and returns 0 cycles, the next exec() call
+		// executes it. Returns false if _addr is not in code memory
+		bool addBreakpoint(uint32_t _addr);
+		void removeBreakpoint(uint32_t _addr);
+		void clearBreakpoints();
+
+		// Data watchpoints. exec() completes the instruction that accessed a watched range and reports
+		// StopReason::Watchpoint, the access is available via getWatchpoints().getHit(). While watchpoints are set, burst
+		// transfers and the loop accelerator are not used
+		WatchpointMap& getWatchpoints() { return m_watchpoints; }
+		const WatchpointMap& getWatchpoints() const { return m_watchpoints; }
+
+		// reason why the last exec() stopped, StopReason::None if the instruction has been executed normally
+		StopReason getStopReason() const { return m_stopReason; }
+
+		// calls exec() until at least _cycles have been executed or a breakpoint or watchpoint has been hit
+		StopReason run(uint64_t _cycles);
+
 		uint64_t getCycles() const { return m_cycles; }
 		
 		Port& getPortE()	{ return m_sim.getPortE(); }
@@ -99,12 +184,67 @@ namespace mc68k
 		CpuState* getCpuState();
 		const CpuState* getCpuState() const;
 
-		bool dumpAssembly(const std::string& _filename, uint32_t _first, uint32_t _count, bool _splitFunctions = true);
-		
+		// Disassembles via the disassembly cache, which is dropped when the code memory is set or host memory is mapped
+		// differently. Clear it via getDisasmCache() if the content of other memory has changed
+		bool dumpAssembly(const std::string& _filename, uint32_t _first, uint32_t _count, bool _splitFunctions = true, uint32_t _threadCount = 1);
+
+		DisasmCache& getDisasmCache() { return m_disasmCache; }
+		const DisasmCache& getDisasmCache() const { return m_disasmCache; }
+
+		void setTraceRecorder(TraceRecorder* _recorder) { m_traceRecorder = _recorder; updateFusion(); }
+		TraceRecorder* getTraceRecorder() const { return m_traceRecorder; }
+
+		void setInputRecorder(InputRecorder* _recorder) { m_inputRecorder = _recorder; }
+		InputRecorder* getInputRecorder() const { return m_inputRecorder; }
+
+		// Executes an instruction from the fusion table and a following branch in one step, unless the instruction caused
+		// an exception, left an interrupt pending or hit a watchpoint. Has no effect while a trace recorder is set or if
+		// MC68K_SINGLE_INSTRUCTION_DISPATCH is off. Disable for debugging
+		void setFusionEnabled(bool _enabled);
+		bool isFusionEnabled() const { return m_fusionEnabled; }
+
+		InstructionFusion& getInstructionFusion() { return m_fusion; }
+
+		// While a hook or a trace recorder is set, exec() uses the instrumented variant of the core's execution loop.
+		// Without them, the plain variant is used that has no hook calls compiled in. Can be changed at any time between
+		// two exec() calls
+		void setInstructionHook(InstructionHook _hook);
+		void setPcChangedHook(PcChangedHook _hook);
+		const InstructionHook& getInstructionHook() const { return m_instructionHook; }
+		const PcChangedHook& getPcChangedHook() const { return m_pcChangedHook; }
+		bool isInstrumented() const { return m_instructionHook || m_traceRecorder; }
+
+		// Attaches a 68881/68882 FPU to the 68020 core. Without it, FPU instructions raise a line F exception, as on the
+		// MC68331, which has no coprocessor interface
+		void setFpuEnabled(bool _enabled);
+		bool isFpuEnabled() const;
+
+		// Computes FPU arithmetic with host doubles instead of 80 bit softfloat. Faster, but only for firmware that does
+		// not depend on extended precision or the FPCR rounding mode. Has no effect unless the FPU is enabled.
+		// The fpuCompare test built with MC68K_BUILD_FPU_COMPARE checks the differences between both modes
+		void setHostFpuEnabled(bool _enabled);
+		bool isHostFpuEnabled() const;
+
+		// RAM / ROM ranges used by burst transfers and the loop accelerator
+		HostMemoryMap& getHostMemoryMap() { return m_hostMemory; }
+		const HostMemoryMap& getHostMemoryMap() const { return m_hostMemory; }
+
+		// Executes DBF copy / clear loops on host memory. Not used while a trace recorder, an instruction or PC changed
+		// hook, a breakpoint, a HLE hook or a watchpoint is set
+		LoopAccelerator& getLoopAccelerator() { return m_loopAccelerator; }
+
+		// interrupts, port inputs and host events from other threads, applied before the next instruction
+		EventMailbox& getEventMailbox() { return m_eventMailbox; }
+
 	protected:
 		void raiseIPL();
+		void onWatchpointHit();
+		void updateFusion();
+		void updateCodeMemory();
+		void patchCode(uint32_t _addr, bool _patch);
 
-		std::array<uint8_t, CpuStateSize> m_cpuStateBuf;
+		// starts at a cache line so that the hot fields at the front of the core state occupy as few lines as possible
+		alignas(64) std::array<uint8_t, CpuStateSize> m_cpuStateBuf;
 		CpuState* m_cpuState;
 
 		Gpt m_gpt;
@@ -114,5 +254,37 @@ namespace mc68k
 		std::array<std::deque<uint8_t>, 8> m_pendingInterrupts;
 
 		uint64_t m_cycles = 0;
+
+		DisasmCache m_disasmCache;
+		uint32_t m_disasmMemoryVersion = 0;
+
+		TraceRecorder* m_traceRecorder = nullptr;
+		InputRecorder* m_inputRecorder = nullptr;
+
+		InstructionFusion m_fusion;
+		bool m_fusionEnabled = false;
+		uint16_t m_lastOpcode = 0;
+		bool m_lastOpcodeValid = false;	// false after an exception, the next instruction does not form a pair with it
+
+		HostMemoryMap m_hostMemory;
+		LoopAccelerator m_loopAccelerator;
+
+		const uint8_t* m_codeMemory = nullptr;
+		uint32_t m_codeAddr = 0;
+		uint32_t m_codeSize = 0;
+		std::vector<uint8_t> m_patchedCode;	// copy of the code memory with HLE hooks and breakpoints patched in
+		std::map<uint32_t, HleHook> m_hleHooks;
+
+		std::set<uint32_t> m_breakpoints;
+		WatchpointMap m_watchpoints;
+		StopReason m_stopReason = StopReason::None;
+		bool m_resumeBreakpoint = false;	// the last exec() stopped at a breakpoint that needs to be stepped over
+		bool m_steppingBreakpoint = false;
+		uint32_t m_breakpointAddr = 0;
+
+		InstructionHook m_instructionHook;
+		PcChangedHook m_pcChangedHook;
+
+		EventMailbox m_eventMailbox;
 	};
 }
@@ -163,5 +163,20 @@ namespace mc68k
 		{
 			writeU16(_buf.data(), _offset, _value);
 		}
+
+		inline void writeU32(uint8_t* _buf, const size_t _offset, uint32_t _value)
+		{
+			auto* p8 = &_buf[_offset];
+			auto* p32 = reinterpret_cast<uint32_t*>(p8);
+
+			_value = endianSwap32IfLittle(_value);
+
+			*p32 = _value;
+		}
+
+		inline void writeU32(std::vector<uint8_t>& _buf, const size_t _offset, const uint32_t _value)
+		{
+			writeU32(_buf.data(), _offset, _value);
+		}
 	}
 }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace mc68k
+{
+	// Bounded lock-free queue, any number of threads may push, a single thread pops. A cell is free for position pos if
+	// its sequence equals pos and readable by the consumer once its sequence is pos + 1
+	template<typename T>
+	class MpscQueue
+	{
+	public:
+		explicit MpscQueue(const uint32_t _capacity) : m_cells(roundUpToPowerOfTwo(_capacity)), m_mask(m_cells.size() - 1)
+		{
+			for(size_t i=0; i<m_cells.size(); ++i)
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		// producer side, returns false if the queue is full
+		bool push(const T& _value)
+		{
+			auto pos = m_writePos.load(std::memory_order_relaxed);
+
+			while(true)
+			{
+				auto& cell = m_cells[pos & m_mask];
+				const auto seq = cell.sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<int64_t>(seq - pos);
+
+				if(diff == 0)
+				{
+					if(m_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						cell.value = _value;
+						cell.sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if(diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = m_writePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// consumer side
+		bool empty() const
+		{
+			return m_cells[m_readPos & m_mask].sequence.load(std::memory_order_acquire) != m_readPos + 1;
+		}
+
+		const T& front() const
+		{
+			return m_cells[m_readPos & m_mask].value;
+		}
+
+		void pop()
+		{
+			m_cells[m_readPos & m_mask].sequence.store(m_readPos + m_mask + 1, std::memory_order_release);
+			++m_readPos;
+		}
+
+	private:
+		static uint32_t roundUpToPowerOfTwo(const uint32_t _value)
+		{
+			uint32_t v = 2;
+			while(v < _value)
+				v <<= 1;
+			return v;
+		}
+
+		struct Cell
+		{
+			std::atomic<uint64_t> sequence;
+			T value;
+		};
+
+		std::vector<Cell> m_cells;
+		uint64_t m_mask;
+
+		alignas(64) std::atomic<uint64_t> m_writePos = 0;
+		alignas(64) uint64_t m_readPos = 0;
+	};
+}
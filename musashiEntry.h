@@ -8,11 +8,52 @@
 #define MC68K_CLASS mc68k::Mc68k
 #endif
 
+// If enabled, data reads and writes are recorded by the trace recorder attached to the instance (if any)
+#ifndef MC68K_TRACE_MEMORY_ACCESSES
+#define MC68K_TRACE_MEMORY_ACCESSES 0
+#endif
+
+#if MC68K_TRACE_MEMORY_ACCESSES
+#include "traceRecorder.h"
+#endif
+
+// If enabled, the 68k core is compiled into the translation unit that includes this file, see end of file
+#ifndef MC68K_INLINE_CORE
+#define MC68K_INLINE_CORE 0
+#endif
+
 MC68K_CLASS* mc68k_get_instance(m68ki_cpu_core* _core)
 {
 	return static_cast<MC68K_CLASS*>(static_cast<mc68k::CpuState*>(_core)->instance);
 }
 
+template<typename TData> TData mc68k_read_memory(m68ki_cpu_core* _core, const unsigned int _addr)
+{
+	auto& instance = *mc68k_get_instance(_core);
+	const auto value = mc68k::memoryOps::read<MC68K_CLASS, TData, false>(instance, _addr);
+	if(instance.getWatchpoints().isWatchedAccess(_addr, sizeof(TData)))
+		instance.onWatchedAccess(_addr, sizeof(TData), value, false);
+#if MC68K_TRACE_MEMORY_ACCESSES
+	auto* trace = instance.getTraceRecorder();
+	if(trace && trace->isRunning())
+		trace->addRead(_addr, value, sizeof(TData), instance.getCycles());
+#endif
+	return value;
+}
+
+template<typename TData> void mc68k_write_memory(m68ki_cpu_core* _core, const unsigned int _addr, const TData _value)
+{
+	auto& instance = *mc68k_get_instance(_core);
+	if(instance.getWatchpoints().isWatchedAccess(_addr, sizeof(TData)))
+		instance.onWatchedAccess(_addr, sizeof(TData), _value, true);
+#if MC68K_TRACE_MEMORY_ACCESSES
+	auto* trace = instance.getTraceRecorder();
+	if(trace && trace->isRunning())
+		trace->addWrite(_addr, _value, sizeof(TData), instance.getCycles());
+#endif
+	mc68k::memoryOps::write<MC68K_CLASS, TData>(instance, _addr, _value);
+}
+
 extern "C"
 {
 	unsigned int m68k_read_immediate_16(m68ki_cpu_core* core, unsigned int address)
@@ -39,27 +80,81 @@ extern "C"
 
 	unsigned int m68k_read_memory_8(m68ki_cpu_core* core, unsigned int address)
 	{
-		return mc68k::memoryOps::read<MC68K_CLASS, uint8_t, false>(*mc68k_get_instance(core), address);
+		return mc68k_read_memory<uint8_t>(core, address);
 	}
 	unsigned int m68k_read_memory_16(m68ki_cpu_core* core, unsigned int address)
 	{
-		return mc68k::memoryOps::read<MC68K_CLASS, uint16_t, false>(*mc68k_get_instance(core), address);
+		return mc68k_read_memory<uint16_t>(core, address);
 	}
 	unsigned int m68k_read_memory_32(m68ki_cpu_core* core, unsigned int address)
 	{
-		return mc68k::memoryOps::read<MC68K_CLASS, uint32_t, false>(*mc68k_get_instance(core), address);
+		return mc68k_read_memory<uint32_t>(core, address);
 	}
 	void m68k_write_memory_8(m68ki_cpu_core* core, unsigned int address, unsigned int value)
 	{
-		mc68k::memoryOps::write<MC68K_CLASS, uint8_t>(*mc68k_get_instance(core), address, static_cast<uint8_t>(value));
+		mc68k_write_memory<uint8_t>(core, address, static_cast<uint8_t>(value));
 	}
 	void m68k_write_memory_16(m68ki_cpu_core* core, unsigned int address, unsigned int value)
 	{
-		mc68k::memoryOps::write<MC68K_CLASS, uint16_t>(*mc68k_get_instance(core), address, static_cast<uint16_t>(value));
+		mc68k_write_memory<uint16_t>(core, address, static_cast<uint16_t>(value));
 	}
 	void m68k_write_memory_32(m68ki_cpu_core* core, unsigned int address, unsigned int value)
 	{
-		mc68k::memoryOps::write<MC68K_CLASS, uint32_t>(*mc68k_get_instance(core), address, value);
+		mc68k_write_memory<uint32_t>(core, address, value);
+	}
+	int m68k_read_memory_burst(m68ki_cpu_core* core, unsigned int address, unsigned int count, unsigned int size, unsigned int* values)
+	{
+		auto& instance = *mc68k_get_instance(core);
+		// let the core fall back to single accesses so that each of them is checked against the watchpoints
+		if(!instance.getWatchpoints().empty())
+			return 0;
+#if MC68K_TRACE_MEMORY_ACCESSES
+		// let the core fall back to single accesses so that each of them is recorded
+		if(instance.getTraceRecorder())
+			return 0;
+#endif
+		const auto* mem = instance.getHostMemoryMap().find(address, count * size, false);
+
+		if(!mem)
+			return 0;
+
+		if(size == 4)
+		{
+			for(unsigned int i=0; i<count; ++i)
+				values[i] = mc68k::memoryOps::readU32(mem, i<<2);
+		}
+		else
+		{
+			for(unsigned int i=0; i<count; ++i)
+				values[i] = mc68k::memoryOps::readU16(mem, i<<1);
+		}
+		return 1;
+	}
+	int m68k_write_memory_burst(m68ki_cpu_core* core, unsigned int address, unsigned int count, unsigned int size, const unsigned int* values)
+	{
+		auto& instance = *mc68k_get_instance(core);
+		if(!instance.getWatchpoints().empty())
+			return 0;
+#if MC68K_TRACE_MEMORY_ACCESSES
+		if(instance.getTraceRecorder())
+			return 0;
+#endif
+		auto* mem = instance.getHostMemoryMap().find(address, count * size, true);
+
+		if(!mem)
+			return 0;
+
+		if(size == 4)
+		{
+			for(unsigned int i=0; i<count; ++i)
+				mc68k::memoryOps::writeU32(mem, i<<2, values[i]);
+		}
+		else
+		{
+			for(unsigned int i=0; i<count; ++i)
+				mc68k::memoryOps::writeU16(mem, i<<1, static_cast<uint16_t>(values[i]));
+		}
+		return 1;
 	}
 	int read_sp_on_reset(m68ki_cpu_core* core)
 	{
@@ -70,3 +165,10 @@ extern "C"
 		return static_cast<int>(mc68k_get_instance(core)->getResetPC());
 	}
 }
+
+#if MC68K_INLINE_CORE
+// The core follows the callbacks above in the same translation unit, which allows the compiler to inline memory
+// accesses into the opcode handlers. The library does not build these files in this case, include this file once only
+#include "Musashi/m68kcpu.c"
+#include "Musashi/m68kops.c"
+#endif
@@ -120,4 +120,26 @@ namespace mc68k
 		TransmitRam0	= 0xffd20,
 		CommandRam0		= 0xffd40,
 	};
+
+	// pin numbers of the general purpose ports
+
+	enum PortEPin : uint8_t
+	{
+		PortE_Dsack0, PortE_Dsack1, PortE_Avec, PortE_Rmc, PortE_Ds, PortE_As, PortE_Siz0, PortE_Siz1
+	};
+
+	enum PortFPin : uint8_t
+	{
+		PortF_Modclk, PortF_Irq1, PortF_Irq2, PortF_Irq3, PortF_Irq4, PortF_Irq5, PortF_Irq6, PortF_Irq7
+	};
+
+	enum PortGPPin : uint8_t
+	{
+		PortGP_Ic1, PortGP_Ic2, PortGP_Ic3, PortGP_Oc1, PortGP_Oc2, PortGP_Oc3, PortGP_Oc4, PortGP_Ic4Oc5
+	};
+
+	enum PortQSPin : uint8_t
+	{
+		PortQS_Miso, PortQS_Mosi, PortQS_Sck, PortQS_Pcs0, PortQS_Pcs1, PortQS_Pcs2, PortQS_Pcs3, PortQS_Txd
+	};
 }
@@ -12,20 +12,97 @@ namespace mc68k
 	void Port::writeTX(const uint8_t _data)
 	{
 		// only write pins that are enabled and that are set to output
-		const auto mask = m_direction & m_enabledPins;
-		m_data &= ~mask;
-		m_data |= _data & mask;
+		writeMasked(_data, getDirection() & m_enabledPins.load(std::memory_order_relaxed));
 		++m_writeCounter;
 
-		m_writeTXCallback(*this);
+		if(!m_txLog.empty())
+			logTX();
+		else
+			m_writeTXCallback(*this);
 	}
 
 	void Port::writeRX(const uint8_t _data)
 	{
 		// only write pins that are enabled and that are set to input
-		const auto mask = (~m_direction) & m_enabledPins;
-		m_data &= ~mask;
-		m_data |= _data & mask;
+		writeMasked(_data, getInputMask());
+	}
+
+	void Port::writeMasked(const uint8_t _data, const uint8_t _mask)
+	{
+		auto current = m_data.load(std::memory_order_relaxed);
+		while(!m_data.compare_exchange_weak(current, static_cast<uint8_t>((current & ~_mask) | (_data & _mask)), std::memory_order_acq_rel))
+		{
+		}
+	}
+
+	void Port::enablePinQueue(const uint32_t _capacity/* = 256*/)
+	{
+		m_pinQueue.reset(new MpscQueue<PinChange>(_capacity));
+	}
+
+	bool Port::queuePinsRX(const uint8_t _setMask, const uint8_t _clearMask, const uint64_t _cycle/* = 0*/)
+	{
+		if(!m_pinQueue)
+			return false;
+		return m_pinQueue->push({_cycle, _setMask, _clearMask});
+	}
+
+	void Port::processPinQueue(const uint64_t _cycles)
+	{
+		const auto& change = m_pinQueue->front();
+
+		if(change.cycle > _cycles)
+			return;
+
+		clearPinsRX(change.clearMask);
+		setPinsRX(change.setMask);
+		m_pinQueue->pop();
+	}
+
+	void Port::enableTXLog(const uint32_t _capacity/* = 4096*/)
+	{
+		uint32_t size = 2;
+		while(size < _capacity)
+			size <<= 1;
+
+		m_txLog.assign(size, TXEvent{});
+		m_txLogMask = size - 1;
+		m_txLogWritePos = 0;
+		m_txLogReadPos = 0;
+		m_txLogOverruns = 0;
+	}
+
+	void Port::disableTXLog()
+	{
+		m_txLog.clear();
+		m_txLog.shrink_to_fit();
+	}
+
+	size_t Port::drainTXLog(std::vector<TXEvent>& _dst)
+	{
+		const auto readPos = m_txLogReadPos.load(std::memory_order_relaxed);
+		const auto writePos = m_txLogWritePos.load(std::memory_order_acquire);
+
+		for(auto i = readPos; i != writePos; ++i)
+			_dst.push_back(m_txLog[i & m_txLogMask]);
+
+		m_txLogReadPos.store(writePos, std::memory_order_release);
+
+		return writePos - readPos;
+	}
+
+	void Port::logTX()
+	{
+		const auto writePos = m_txLogWritePos.load(std::memory_order_relaxed);
+
+		if(writePos - m_txLogReadPos.load(std::memory_order_acquire) > m_txLogMask)
+		{
+			m_txLogOverruns.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		m_txLog[writePos & m_txLogMask] = {m_cycles, getData(), getDirection()};
+		m_txLogWritePos.store(writePos + 1, std::memory_order_release);
 	}
 
 	void Port::setDirectionChangeCallback(const std::function<void(const Port&)>& _func)
@@ -1,27 +1,52 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <vector>
+
+#include "mpscQueue.h"
 
 namespace mc68k
 {
+	// Pin state is atomic, setPinsRX(), clearPinsRX(), setBitRX(), clearBitRX(), writeRX() and queuePinsRX() may be
+	// called from any thread while the firmware accesses the port on the emulation thread. Callbacks and direction
+	// changes are emulation thread only
 	class Port
 	{
 	public:
+		struct TXEvent
+		{
+			uint64_t cycle;
+			uint8_t data;
+			uint8_t direction;
+		};
+
 		Port();
 
+		// cycle of the instruction that is currently executed
+		uint64_t getCycles() const
+		{
+			return m_cycles;
+		}
+
 		uint8_t getDirection() const
 		{
-			return m_direction;
+			return m_direction.load(std::memory_order_relaxed);
 		}
 
 		void setDirection(const uint8_t _dir)
 		{
-			if(m_direction == _dir)
+			if(getDirection() == _dir)
 				return;
 
-			m_direction = _dir;
-			m_dirChangeCallback(*this);
+			m_direction.store(_dir, std::memory_order_relaxed);
+
+			if(!m_txLog.empty())
+				logTX();
+			else
+				m_dirChangeCallback(*this);
 		}
 
 		void writeTX(uint8_t _data);
@@ -29,12 +54,18 @@ namespace mc68k
 
 		uint8_t read() const
 		{
-			return m_readRXCallback(*this, m_data);
+			return m_readRXCallback(*this, getData());
+		}
+
+		// current pin state without invoking the read callback
+		uint8_t getData() const
+		{
+			return m_data.load(std::memory_order_acquire);
 		}
 
 		void enablePins(uint8_t _pins)
 		{
-			m_enabledPins = _pins;
+			m_enabledPins.store(_pins, std::memory_order_relaxed);
 		}
 
 		uint32_t getWriteCounter() const
@@ -47,14 +78,47 @@ namespace mc68k
 			return read() & (1<<_bit);
 		}
 
+		// atomic masked updates of input pins
+		void setPinsRX(const uint8_t _mask)
+		{
+			m_data.fetch_or(_mask & getInputMask(), std::memory_order_acq_rel);
+		}
+
+		void clearPinsRX(const uint8_t _mask)
+		{
+			m_data.fetch_and(static_cast<uint8_t>(~(_mask & getInputMask())), std::memory_order_acq_rel);
+		}
+
 		void setBitRX(uint32_t _bit)
 		{
-			writeRX(read() | static_cast<uint8_t>(1 << _bit));
+			setPinsRX(static_cast<uint8_t>(1 << _bit));
 		}
 
 		void clearBitRX(uint32_t _bit)
 		{
-			writeRX(read() & ~(1<<_bit));
+			clearPinsRX(static_cast<uint8_t>(1 << _bit));
+		}
+
+		// Optional queue of cycle-stamped input pin changes. Queued changes are applied in order on the emulation thread
+		// once their cycle has been reached, at most one per instruction so that the firmware can see every state
+		void enablePinQueue(uint32_t _capacity = 256);
+		bool queuePinsRX(uint8_t _setMask, uint8_t _clearMask, uint64_t _cycle = 0);
+
+		// Optional log of output writes and direction changes. While enabled, they are recorded with the cycle of the
+		// instruction that caused them into a ring buffer instead of invoking the write and direction change callbacks.
+		// The host drains the log in bulk from any single thread, if it is full new events are dropped and counted
+		void enableTXLog(uint32_t _capacity = 4096);
+		void disableTXLog();
+		size_t drainTXLog(std::vector<TXEvent>& _dst);
+		uint32_t getTXLogOverruns() const { return m_txLogOverruns.load(std::memory_order_relaxed); }
+
+		// called by the owning peripheral on the emulation thread
+		void exec(const uint64_t _cycles)
+		{
+			m_cycles = _cycles;
+
+			if(m_pinQueue && !m_pinQueue->empty())
+				processPinQueue(_cycles);
 		}
 
 		void setDirectionChangeCallback(const std::function<void(const Port&)>& _func);
@@ -62,10 +126,35 @@ namespace mc68k
 		void setReadRXCallback(const std::function<uint8_t(const Port&, uint8_t)>& _func);
 
 	private:
-		uint8_t m_direction = 0;		// 0 = input, 1 = output
-		uint8_t m_enabledPins = 0xff;
-		uint8_t m_data = 0;
+		struct PinChange
+		{
+			uint64_t cycle;
+			uint8_t setMask;
+			uint8_t clearMask;
+		};
+
+		uint8_t getInputMask() const
+		{
+			return static_cast<uint8_t>(~m_direction.load(std::memory_order_relaxed) & m_enabledPins.load(std::memory_order_relaxed));
+		}
+
+		void writeMasked(uint8_t _data, uint8_t _mask);
+		void logTX();
+		void processPinQueue(uint64_t _cycles);
+
+		std::atomic<uint8_t> m_direction = 0;		// 0 = input, 1 = output
+		std::atomic<uint8_t> m_enabledPins = 0xff;
+		std::atomic<uint8_t> m_data = 0;
 		uint32_t m_writeCounter = 0;
+		std::unique_ptr<MpscQueue<PinChange>> m_pinQueue;
+		uint64_t m_cycles = 0;
+
+		std::vector<TXEvent> m_txLog;
+		uint32_t m_txLogMask = 0;
+		std::atomic<uint32_t> m_txLogWritePos = 0;
+		std::atomic<uint32_t> m_txLogReadPos = 0;
+		std::atomic<uint32_t> m_txLogOverruns = 0;
+
 		std::function<void(const Port&)> m_dirChangeCallback;
 		std::function<void(const Port&)> m_writeTXCallback;
 		std::function<uint8_t(const Port&, uint8_t)> m_readRXCallback;
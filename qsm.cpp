@@ -1,5 +1,7 @@
 #include "qsm.h"
 
+#include <algorithm>
+
 #include "logging.h"
 #include "mc68k.h"
 
@@ -23,7 +25,7 @@ namespace mc68k
 	constexpr uint16_t g_spsr_spifMask		= (1<<7);
 	constexpr uint16_t g_spsr_haltAckMask	= (1<<5);
 
-	constexpr uint32_t g_sciRxDelay = 50;
+	constexpr uint16_t g_sccr0_scbrMask		= 0x1fff;
 
 	Qsm::Qsm(Mc68k& _mc68k) : m_mc68k(_mc68k), m_qspi(*this)
 	{
@@ -193,6 +195,8 @@ namespace mc68k
 	{
 		PeripheralBase::exec(_deltaCycles);
 
+		m_portQS.exec(m_mc68k.getCycles());
+
 		m_qspi.exec();
 
 		if(m_nextQueue != 0xff)
@@ -205,7 +209,9 @@ namespace mc68k
 
 		// SCI
 
-		if(m_pendingTxDataCounter == 2)
+		const auto cycles = m_mc68k.getCycles();
+
+		if(m_pendingTxDataCounter == 2 && cycles >= m_sciTxEmptyCycle)
 		{
 			--m_pendingTxDataCounter;
 			set(ScsrBits::TransmitDataRegisterEmpty);
@@ -213,7 +219,7 @@ namespace mc68k
 			if(bitTest(Sccr1Bits::TransmitInterruptEnable))
 				injectInterrupt(ScsrBits::TransmitDataRegisterEmpty);
 		}
-		else if(m_pendingTxDataCounter == 1)
+		else if(m_pendingTxDataCounter == 1 && cycles >= m_sciTxCompleteCycle)
 		{
 			--m_pendingTxDataCounter;
 
@@ -223,13 +229,17 @@ namespace mc68k
 				injectInterrupt(ScsrBits::TransmitComplete);
 		}
 
-		if(m_sciRxDelay > 0)
-		{
-			--m_sciRxDelay;
+		if(m_sciRxDataEmpty)
 			return;
+
+		if(!m_sciRxScheduled)
+		{
+			std::lock_guard lock(m_mutexSciRx);
+			m_sciRxCycle = std::max(m_sciRxCycle, m_sciRxData.front().cycle);
+			m_sciRxScheduled = true;
 		}
 
-		if(m_sciRxDataEmpty)
+		if(cycles < m_sciRxCycle)
 			return;
 
 		if(!bitTest(Sccr1Bits::ReceiverEnable))
@@ -241,6 +251,9 @@ namespace mc68k
 
 		if(!bitTest(ScsrBits::ReceiveDataRegisterFull))
 		{
+			// received now, the next data follows one frame later, also if this was scheduled in the past
+			m_sciRxCycle = cycles;
+
 			set(ScsrBits::ReceiveDataRegisterFull);
 
 			if(bitTest(Sccr1Bits::ReceiverInterruptEnable))
@@ -248,20 +261,44 @@ namespace mc68k
 		}
 	}
 
-	void Qsm::writeSciRX(uint16_t _data)
+	void Qsm::writeSciRX(const uint16_t _data, const uint64_t _cycle/* = 0*/)
 	{
 		std::lock_guard lock(m_mutexSciRx);
-		m_sciRxData.push_back(_data);
+		m_sciRxData.push_back({_data, _cycle});
 		m_sciRxDataEmpty = false;
 	}
 
 	void Qsm::readSciTX(std::deque<uint16_t>& _dst)
+	{
+		_dst.clear();
+
+		std::lock_guard lock(m_mutexSciTx);
+		for (const auto& d : m_sciTxData)
+			_dst.push_back(d.data);
+		m_sciTxData.clear();
+	}
+
+	void Qsm::readSciTX(std::deque<SciData>& _dst)
 	{
 		std::lock_guard lock(m_mutexSciTx);
 		m_sciTxData.swap(_dst);
 		m_sciTxData.clear();
 	}
 
+	uint32_t Qsm::getSciFrameCycles()
+	{
+		// the SCI baud clock is the system clock divided by 32 * SCBR, the CPU runs at the system clock
+		const uint32_t scbr = read16(PeriphAddress::SciControl0) & g_sccr0_scbrMask;
+		const uint32_t bits = bitTest(Sccr1Bits::ModeSelect) ? 11 : 10;
+		return 32 * scbr * bits;
+	}
+
+	uint32_t Qsm::getSciBaudRate()
+	{
+		const uint32_t scbr = read16(PeriphAddress::SciControl0) & g_sccr0_scbrMask;
+		return scbr ? m_mc68k.getSim().getSystemClockHz() / (32 * scbr) : 0;
+	}
+
 	void Qsm::setSpiWriteCallback(const SpiTxCallback& _callback)
 	{
 		m_spiTxCallback = _callback;
@@ -388,15 +425,28 @@ namespace mc68k
 		if(m_sciRxData.empty())
 		{
 //			MCLOG("Empty SCI read");
-			return 0;
+			return m_sciRxLast;
 		}
 
+		if(!m_sciRxScheduled)
+		{
+			m_sciRxCycle = std::max(m_sciRxCycle, m_sciRxData.front().cycle);
+			m_sciRxScheduled = true;
+		}
+
+		// data that has not been received yet stays queued, the data register still holds the previous data
+		if(!bitTest(ScsrBits::ReceiveDataRegisterFull) && m_mc68k.getCycles() < m_sciRxCycle)
+			return m_sciRxLast;
+
 		clear(ScsrBits::ReceiveDataRegisterFull);
-		const auto res = m_sciRxData.front();
+		m_sciRxLast = m_sciRxData.front().data;
 		m_sciRxData.pop_front();
 		m_sciRxDataEmpty = m_sciRxData.empty();
-		m_sciRxDelay = g_sciRxDelay;
-		return res;
+
+		// the next data can not be received earlier than one frame after this one
+		m_sciRxCycle += getSciFrameCycles();
+		m_sciRxScheduled = false;
+		return m_sciRxLast;
 	}
 
 	void Qsm::finishTransfer()
@@ -459,18 +509,33 @@ namespace mc68k
 		if(!bitTest(Sccr1Bits::TransmitterEnable))
 			return;
 
+		const auto cycles = m_mc68k.getCycles();
+
 		{
 			std::lock_guard lock(m_mutexSciTx);
-			m_sciTxData.push_back(_data);
+			m_sciTxData.push_back({_data, cycles});
 		}
+
+		// the data moves to the shift register once the previous frame has been sent
+		m_sciTxEmptyCycle = std::max(cycles, m_sciTxCompleteCycle);
+		m_sciTxCompleteCycle = m_sciTxEmptyCycle + getSciFrameCycles();
 		m_pendingTxDataCounter = 2;
 	}
 
 	uint16_t Qsm::readSciStatus()
 	{
-		// we're always done with everything
-		set(ScsrBits::TransmitDataRegisterEmpty);
-		set(ScsrBits::TransmitComplete);
+		const auto cycles = m_mc68k.getCycles();
+
+		if(cycles >= m_sciTxEmptyCycle)
+			set(ScsrBits::TransmitDataRegisterEmpty);
+		else
+			clear(ScsrBits::TransmitDataRegisterEmpty);
+
+		if(cycles >= m_sciTxCompleteCycle)
+			set(ScsrBits::TransmitComplete);
+		else
+			clear(ScsrBits::TransmitComplete);
+
 		const auto r = PeripheralBase::read16(PeriphAddress::SciStatus);
 //		MCLOG("Read SCSR, res=" << MCHEXN(r, 4));
 		return r;
@@ -18,6 +18,12 @@ namespace mc68k
 		using SpiTxCallback = std::function<void(uint16_t, uint8_t)>;
 		using SpiTxFinishCallback = std::function<void(uint8_t)>;
 
+		struct SciData
+		{
+			uint16_t data;
+			uint64_t cycle;
+		};
+
 		enum class Sccr1Bits
 		{
 			SendBreak,
@@ -72,8 +78,17 @@ namespace mc68k
 		void spcr3(uint16_t _value)	{ PeripheralBase::write16(PeriphAddress::Spcr3, _value); }
 		void spsr(uint8_t _value)	{ PeripheralBase::write8(PeriphAddress::Spsr, _value); }
 
-		void writeSciRX(uint16_t _data);
+		// RX data is received at the given cycle but not earlier than one frame after the previous data, the frame length
+		// follows the baud rate set in SCCR0. Without a cycle, data is received as soon as the line allows it
+		void writeSciRX(uint16_t _data, uint64_t _cycle = 0);
+
+		// returns TX data with or without the cycle at which the firmware wrote it
 		void readSciTX(std::deque<uint16_t>& _dst);
+		void readSciTX(std::deque<SciData>& _dst);
+
+		// cycles per SCI frame (start bit, 8 or 9 data bits, stop bit), 0 if the baud rate generator is disabled
+		uint32_t getSciFrameCycles();
+		uint32_t getSciBaudRate();
 
 		Port& getPortQS() { return m_portQS; }
 
@@ -107,12 +122,16 @@ namespace mc68k
 		std::deque<uint16_t> m_spiTxData;
 
 		std::mutex m_mutexSciTx;
-		std::deque<uint16_t> m_sciTxData;
+		std::deque<SciData> m_sciTxData;
+		uint64_t m_sciTxEmptyCycle = 0;		// transmit data register empty, data has been moved to the shift register
+		uint64_t m_sciTxCompleteCycle = 0;	// shift register empty
 
 		std::mutex m_mutexSciRx;
-		std::deque<uint16_t> m_sciRxData;
+		std::deque<SciData> m_sciRxData;
 		bool m_sciRxDataEmpty = true;
-		uint32_t m_sciRxDelay = 0;
+		bool m_sciRxScheduled = false;		// m_sciRxCycle is valid for the front of m_sciRxData
+		uint64_t m_sciRxCycle = 0;
+		uint16_t m_sciRxLast = 0;			// returned if the firmware reads before the next data has been received
 
 		uint16_t m_pendingTxDataCounter = 0;
 
@@ -0,0 +1,126 @@
+#include "realTimePacer.h"
+
+#include <algorithm>
+
+#include "mc68k.h"
+
+namespace mc68k
+{
+	RealTimePacer::RealTimePacer(Mc68k& _mc68k, const Reference _reference) : m_mc68k(_mc68k), m_reference(_reference)
+	{
+		reset();
+	}
+
+	void RealTimePacer::setQuantumLimits(const double _minSeconds, const double _maxSeconds)
+	{
+		m_minQuantum = _minSeconds;
+		m_maxQuantum = std::max(_minSeconds, _maxSeconds);
+	}
+
+	void RealTimePacer::reset()
+	{
+		m_emulatedTime = 0.0;
+		m_lastCycles = m_mc68k.getCycles();
+		m_quantumCycles = static_cast<uint64_t>(m_minQuantum * m_mc68k.getSim().getSystemClockHz());
+		m_referenceOffset = 0.0;
+		m_start = Clock::now();
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_hostTime = 0.0;
+		}
+
+		m_lag = 0.0;
+		m_maxMeasuredLag = 0.0;
+		m_resyncCount = 0;
+	}
+
+	void RealTimePacer::advanceReference(const double _seconds)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_hostTime += _seconds;
+		}
+		m_cv.notify_one();
+	}
+
+	StopReason RealTimePacer::exec()
+	{
+		const auto reason = m_mc68k.run(std::max<uint64_t>(m_quantumCycles, 1));
+
+		const auto clockHz = static_cast<double>(m_mc68k.getSim().getSystemClockHz());
+		const auto cycles = m_mc68k.getCycles();
+
+		m_emulatedTime += static_cast<double>(cycles - m_lastCycles) / clockHz;
+		m_lastCycles = cycles;
+
+		const auto lead = m_emulatedTime - getReferenceTime();
+
+		if(lead > m_maxLead)
+		{
+			// ahead, use a quantum that is small compared to the allowed lead to keep the lead steady
+			m_quantumCycles = static_cast<uint64_t>(std::clamp(m_maxLead * 0.25, m_minQuantum, m_maxQuantum) * clockHz);
+			m_lag = 0.0;
+
+			wait(lead - m_maxLead);
+		}
+		else if(lead < 0.0)
+		{
+			const auto lag = -lead;
+
+			m_lag = lag;
+			if(lag > m_maxMeasuredLag)
+				m_maxMeasuredLag = lag;
+
+			if(lag > m_maxLag)
+			{
+				m_referenceOffset += lag;
+				++m_resyncCount;
+			}
+
+			// behind, check less often to spend more time emulating
+			m_quantumCycles = std::min(m_quantumCycles * 2, static_cast<uint64_t>(m_maxQuantum * clockHz));
+		}
+		else
+		{
+			m_lag = 0.0;
+		}
+
+		return reason;
+	}
+
+	void RealTimePacer::wake()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_wake = true;
+		}
+		m_cv.notify_one();
+	}
+
+	double RealTimePacer::getReferenceTime()
+	{
+		if(m_reference == Reference::WallClock)
+			return std::chrono::duration<double>(Clock::now() - m_start).count() - m_referenceOffset;
+
+		std::lock_guard lock(m_mutex);
+		return m_hostTime - m_referenceOffset;
+	}
+
+	void RealTimePacer::wait(const double _seconds)
+	{
+		std::unique_lock lock(m_mutex);
+
+		if(m_reference == Reference::WallClock)
+		{
+			m_cv.wait_for(lock, std::chrono::duration<double>(_seconds), [this] { return m_wake; });
+		}
+		else
+		{
+			const auto target = m_emulatedTime - m_maxLead + m_referenceOffset;
+			m_cv.wait(lock, [&] { return m_wake || m_hostTime >= target; });
+		}
+
+		m_wake = false;
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace mc68k
+{
+	class Mc68k;
+	enum class StopReason : uint8_t;
+
+	// Keeps an emulation thread locked to a reference clock. exec() runs one quantum and then compares the emulated
+	// time, derived from the cycles and the system clock of the SIM, to the reference. If the emulation is further
+	// ahead than the allowed lead, it waits until the reference catches up. If it falls further behind than the allowed
+	// lag, the reference is resynced instead of catching up at full speed, which would otherwise add latency for a long
+	// time after a stall.
+	// The reference is either the wall clock or a clock that the host advances, for example from its audio callback.
+	// The quantum adapts to the allowed lead when ahead and grows to reduce overhead while behind
+	class RealTimePacer
+	{
+	public:
+		enum class Reference : uint8_t
+		{
+			WallClock,
+			Host
+		};
+
+		explicit RealTimePacer(Mc68k& _mc68k, Reference _reference = Reference::WallClock);
+
+		void setMaxLead(double _seconds) { m_maxLead = _seconds; }
+		void setMaxLag(double _seconds) { m_maxLag = _seconds; }
+		void setQuantumLimits(double _minSeconds, double _maxSeconds);
+
+		// starts over with emulated and reference time in sync
+		void reset();
+
+		// host reference, can be called from any thread
+		void advanceReference(double _seconds);
+		void advanceReference(uint32_t _samples, uint32_t _sampleRate)
+		{
+			advanceReference(static_cast<double>(_samples) / static_cast<double>(_sampleRate));
+		}
+
+		// emulation thread, runs one quantum and waits if ahead
+		StopReason exec();
+
+		// wakes up a waiting exec(), for example to shut down the emulation thread
+		void wake();
+
+		double getLag() const { return m_lag.load(std::memory_order_relaxed); }
+		double getMaxMeasuredLag() const { return m_maxMeasuredLag.load(std::memory_order_relaxed); }
+		uint32_t getResyncCount() const { return m_resyncCount.load(std::memory_order_relaxed); }
+		uint64_t getQuantumCycles() const { return m_quantumCycles; }
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		double getReferenceTime();
+		void wait(double _seconds);
+
+		Mc68k& m_mc68k;
+		const Reference m_reference;
+
+		double m_maxLead = 0.005;
+		double m_maxLag = 0.1;
+		double m_minQuantum = 0.0001;
+		double m_maxQuantum = 0.002;
+
+		// emulated time is accumulated per quantum so that clock changes of the SIM are taken into account
+		double m_emulatedTime = 0.0;
+		uint64_t m_lastCycles = 0;
+		uint64_t m_quantumCycles = 0;
+
+		double m_referenceOffset = 0.0;		// subtracted from the reference, increased on resync
+		Clock::time_point m_start;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		double m_hostTime = 0.0;
+		bool m_wake = false;
+
+		std::atomic<double> m_lag = 0.0;
+		std::atomic<double> m_maxMeasuredLag = 0.0;
+		std::atomic<uint32_t> m_resyncCount = 0;
+	};
+}
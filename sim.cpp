@@ -147,6 +147,9 @@ namespace mc68k
 
 	void Sim::exec(const uint32_t _deltaCycles)
 	{
+		m_portE.exec(m_mc68k.getCycles());
+		m_portF.exec(m_mc68k.getCycles());
+
 		if(!m_timerLoadValue)
 			return;
 
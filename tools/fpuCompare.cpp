@@ -0,0 +1,207 @@
+// Compares FPU arithmetic in softfloat and host double mode, see Mc68k::setHostFpuEnabled(). The same instructions
+// are executed with the same random operands on two cores with an FPU, one per mode, and the results are compared in
+// units in the last place (ULP) of a double. Build with MC68K_BUILD_FPU_COMPARE=ON, it is registered as a ctest test
+//
+// usage: fpuCompare [iterations per operation] [seed] [max ULP]
+// Returns 1 if a result differs by more than max ULP (default 1) or if a compare sets other condition codes
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "cpuState.h"
+#include "mc68k.h"
+#include "musashiEntry.h"
+
+namespace
+{
+	constexpr uint32_t g_codeAddr = 0x400;
+	constexpr uint32_t g_fpsrConditionMask = 0x0f000000;
+
+	struct Operation
+	{
+		const char* name;
+		uint16_t opmode;
+		bool unary;
+		bool compare;
+	};
+
+	constexpr Operation g_operations[] =
+	{
+		{"fadd",	0x22, false, false},
+		{"fsub",	0x28, false, false},
+		{"fmul",	0x23, false, false},
+		{"fdiv",	0x20, false, false},
+		{"fsqrt",	0x04, true, false},
+		{"fcmp",	0x38, false, true},
+	};
+
+	class FpuCpu final : public mc68k::Mc68k
+	{
+	public:
+		explicit FpuCpu(const bool _hostDouble) : m_mem(0x1000, 0)
+		{
+			// initial SSP and PC
+			mc68k::memoryOps::writeU16(m_mem, 2, 0x0800);
+			mc68k::memoryOps::writeU16(m_mem, 6, g_codeAddr);
+
+			reset();
+			setFpuEnabled(true);
+			setHostFpuEnabled(_hostDouble);
+		}
+
+		uint32_t getResetPC() override { return g_codeAddr; }
+		uint32_t getResetSP() override { return 0x800; }
+
+		uint16_t readImm16(const uint32_t _addr) override { return mc68k::memoryOps::readU16(m_mem, _addr & 0xffe); }
+		uint16_t read16(const uint32_t _addr) override { return mc68k::memoryOps::readU16(m_mem, _addr & 0xffe); }
+		uint8_t read8(const uint32_t _addr) override { return m_mem[_addr & 0xfff]; }
+
+		// executes <op> FP1,FP0 and returns FP0
+		floatx80 execOp(const Operation& _op, const floatx80& _dst, const floatx80& _src, uint32_t& _fpsr)
+		{
+			mc68k::memoryOps::writeU16(m_mem, g_codeAddr, 0xf200);
+			mc68k::memoryOps::writeU16(m_mem, g_codeAddr + 2, static_cast<uint16_t>(1 << 10 | _op.opmode));
+
+			auto* cpu = getCpuState();
+			cpu->fpr[0] = _dst;
+			cpu->fpr[1] = _src;
+			cpu->fpsr = 0;
+
+			setPC(g_codeAddr);
+			Mc68k::exec();
+
+			_fpsr = cpu->fpsr;
+			return cpu->fpr[0];
+		}
+
+	private:
+		std::vector<uint8_t> m_mem;
+	};
+
+	floatx80 toFloatx80(const double _d)
+	{
+		uint64_t bits;
+		memcpy(&bits, &_d, sizeof(bits));
+		return float64_to_floatx80(bits);
+	}
+
+	double toDouble(const floatx80& _f)
+	{
+		const uint64_t bits = floatx80_to_float64(_f);
+		double d;
+		memcpy(&d, &bits, sizeof(d));
+		return d;
+	}
+
+	// distance in representable doubles, equal NaNs and zeros of both signs are 0 apart
+	uint64_t ulpDistance(const double _a, const double _b)
+	{
+		if(std::isnan(_a) || std::isnan(_b))
+			return std::isnan(_a) && std::isnan(_b) ? 0 : std::numeric_limits<uint64_t>::max();
+
+		auto ordered = [](const double _d)
+		{
+			int64_t i;
+			memcpy(&i, &_d, sizeof(i));
+			return i < 0 ? std::numeric_limits<int64_t>::min() - i : i;
+		};
+
+		const auto a = ordered(_a);
+		const auto b = ordered(_b);
+		return a > b ? static_cast<uint64_t>(a) - static_cast<uint64_t>(b) : static_cast<uint64_t>(b) - static_cast<uint64_t>(a);
+	}
+
+	// mostly normal numbers over a wide exponent range plus special values
+	double randomOperand(std::mt19937_64& _rng)
+	{
+		static constexpr double specials[] =
+		{
+			0.0, -0.0, 1.0, -1.0, 0.5, 2.0,
+			std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+			std::numeric_limits<double>::quiet_NaN(),
+			std::numeric_limits<double>::min(), std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::max(),
+		};
+
+		const auto r = _rng();
+
+		if((r & 0xff) < 8)
+			return specials[(r >> 8) % std::size(specials)];
+
+		const auto mantissa = std::uniform_real_distribution<double>(1.0, 2.0)(_rng);
+		const auto exponent = static_cast<int>((r >> 16) % 601) - 300;
+		const auto sign = (r >> 40) & 1 ? -1.0 : 1.0;
+
+		return sign * std::ldexp(mantissa, exponent);
+	}
+}
+
+int main(const int _argc, char* _argv[])
+{
+	const auto iterations = _argc > 1 ? strtoull(_argv[1], nullptr, 10) : 100000ull;
+	const auto seed = _argc > 2 ? strtoull(_argv[2], nullptr, 10) : 1ull;
+	const auto maxUlp = _argc > 3 ? strtoull(_argv[3], nullptr, 10) : 1ull;
+
+	FpuCpu softFloat(false);
+	FpuCpu hostDouble(true);
+
+	std::mt19937_64 rng(seed);
+
+	bool failed = false;
+
+	printf("%-6s %12s %12s %12s %10s\n", "op", "operations", "differing", "max ULP", "mean ULP");
+
+	for (const auto& op : g_operations)
+	{
+		uint64_t differing = 0;
+		uint64_t worst = 0;
+		double sum = 0;
+		double worstDst = 0, worstSrc = 0;
+
+		for(uint64_t i=0; i<iterations; ++i)
+		{
+			const auto dst = randomOperand(rng);
+			const auto src = op.unary ? dst : randomOperand(rng);
+
+			uint32_t fpsrSoft, fpsrHost;
+			const auto soft = toDouble(softFloat.execOp(op, toFloatx80(dst), toFloatx80(src), fpsrSoft));
+			const auto host = toDouble(hostDouble.execOp(op, toFloatx80(dst), toFloatx80(src), fpsrHost));
+
+			const auto ulp = op.compare ? ((fpsrSoft ^ fpsrHost) & g_fpsrConditionMask ? std::numeric_limits<uint64_t>::max() : 0) : ulpDistance(soft, host);
+
+			if(!ulp)
+				continue;
+
+			++differing;
+			sum += static_cast<double>(ulp);
+
+			if(ulp > worst)
+			{
+				worst = ulp;
+				worstDst = dst;
+				worstSrc = src;
+			}
+		}
+
+		if(worst == std::numeric_limits<uint64_t>::max())
+			printf("%-6s %12" PRIu64 " %12" PRIu64 " %12s %10s", op.name, static_cast<uint64_t>(iterations), differing, "mismatch", "-");
+		else
+			printf("%-6s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %10.4f", op.name, static_cast<uint64_t>(iterations), differing, worst, iterations ? sum / static_cast<double>(iterations) : 0.0);
+
+		if(worst > maxUlp)
+		{
+			printf("  worst: %.17g, %.17g", worstDst, worstSrc);
+			failed = true;
+		}
+
+		printf("\n");
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+#include "traceRecorder.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "logging.h"
+#include "mc68k.h"
+
+namespace mc68k
+{
+	namespace
+	{
+		constexpr char g_traceMagic[8] = {'M','6','8','K','T','R','C','1'};
+
+		struct TraceFileHeader
+		{
+			char magic[8];
+			uint32_t recordSize;
+			uint32_t reserved;
+		};
+	}
+
+	TraceRecorder::TraceRecorder(const uint32_t _chunkSize) : m_chunkSize(_chunkSize)
+	{
+	}
+
+	TraceRecorder::~TraceRecorder()
+	{
+		stop();
+	}
+
+	bool TraceRecorder::start(const std::string& _filename)
+	{
+		stop();
+
+		m_file = fopen(_filename.c_str(), "wb");
+
+		if(!m_file)
+		{
+			MCLOG("Failed to create trace file " << _filename);
+			return false;
+		}
+
+		TraceFileHeader header{};
+		memcpy(header.magic, g_traceMagic, sizeof(g_traceMagic));
+		header.recordSize = sizeof(Record);
+		fwrite(&header, sizeof(header), 1, m_file);
+
+		m_recordCount = 0;
+		m_stopThread = false;
+
+		nextChunk();
+
+		m_thread.reset(new std::thread([this]
+		{
+			threadFunc();
+		}));
+
+		return true;
+	}
+
+	void TraceRecorder::stop()
+	{
+		if(!m_file)
+			return;
+
+		submitChunk(m_writePos - m_chunkBegin);
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopThread = true;
+		}
+		m_cv.notify_one();
+
+		m_thread->join();
+		m_thread.reset();
+
+		m_chunkBegin = m_chunkEnd = m_writePos = nullptr;
+
+		fclose(m_file);
+		m_file = nullptr;
+	}
+
+	void TraceRecorder::nextChunk()
+	{
+		if(m_chunk)
+			submitChunk(m_chunk->size());
+
+		{
+			std::lock_guard lock(m_mutex);
+
+			if(!m_freeChunks.empty())
+			{
+				m_chunk = std::move(m_freeChunks.back());
+				m_freeChunks.pop_back();
+			}
+		}
+
+		if(!m_chunk)
+			m_chunk.reset(new Chunk(m_chunkSize));
+
+		m_chunkBegin = m_writePos = m_chunk->data();
+		m_chunkEnd = m_chunkBegin + m_chunk->size();
+	}
+
+	void TraceRecorder::submitChunk(const size_t _recordCount)
+	{
+		if(!m_chunk)
+			return;
+
+		m_recordCount += _recordCount;
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_filledChunks.emplace_back(std::move(m_chunk), _recordCount);
+		}
+		m_cv.notify_one();
+
+		m_chunkBegin = m_chunkEnd = m_writePos = nullptr;
+	}
+
+	void TraceRecorder::threadFunc()
+	{
+		std::vector<std::pair<std::unique_ptr<Chunk>, size_t>> chunks;
+
+		while(true)
+		{
+			bool stop;
+
+			{
+				std::unique_lock lock(m_mutex);
+				m_cv.wait(lock, [this] { return m_stopThread || !m_filledChunks.empty(); });
+				std::swap(chunks, m_filledChunks);
+				stop = m_stopThread;
+			}
+
+			for (auto& [chunk, count] : chunks)
+				fwrite(chunk->data(), sizeof(Record), count, m_file);
+
+			{
+				std::lock_guard lock(m_mutex);
+				for (auto& c : chunks)
+				{
+					if(m_freeChunks.size() < MaxFreeChunks)
+						m_freeChunks.emplace_back(std::move(c.first));
+				}
+			}
+
+			chunks.clear();
+
+			if(stop)
+				break;
+		}
+
+		fflush(m_file);
+	}
+
+	bool TraceRecorder::decode(const std::string& _traceFilename, const std::string& _outFilename, Mc68k& _mc68k)
+	{
+		FILE* in = fopen(_traceFilename.c_str(), "rb");
+
+		if(!in)
+			return false;
+
+		TraceFileHeader header{};
+
+		if(fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, g_traceMagic, sizeof(g_traceMagic)) != 0 || header.recordSize != sizeof(Record))
+		{
+			MCLOG("Invalid trace file " << _traceFilename);
+			fclose(in);
+			return false;
+		}
+
+		std::ofstream out(_outFilename, std::ios::out);
+
+		if(!out.is_open())
+		{
+			fclose(in);
+			return false;
+		}
+
+		// firmware spends most of its time in loops, disassemble every PC only once
+		std::unordered_map<uint32_t, std::string> disasmCache;
+
+		std::vector<Record> records(DefaultChunkSize);
+
+		while(true)
+		{
+			const auto count = fread(records.data(), sizeof(Record), records.size(), in);
+
+			if(!count)
+				break;
+
+			for(size_t i=0; i<count; ++i)
+			{
+				const auto& r = records[i];
+
+				if(r.type != RecordType::Instruction)
+				{
+					out << "\t\t\t" << (r.type == RecordType::Read ? "R" : "W") << static_cast<uint32_t>(r.size) << ' ' << MCHEXN(r.address, 8) << " = " << MCHEXN(r.data, r.size << 1) << '\n';
+					continue;
+				}
+
+				auto it = disasmCache.find(r.address);
+
+				if(it == disasmCache.end())
+				{
+					char disasm[64];
+					_mc68k.disassemble(r.address, disasm);
+					it = disasmCache.insert(std::make_pair(r.address, std::string(disasm))).first;
+				}
+
+				out << std::dec << r.cycles() << '\t' << MCHEXN(r.address, 6) << '\t' << MCHEXN(r.data, 4) << '\t' << it->second << '\n';
+			}
+		}
+
+		fclose(in);
+		return true;
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mc68k
+{
+	class Mc68k;
+
+	// Records executed instructions and (optionally) memory accesses as compact binary records. Records are written to
+	// fixed size chunks on the emulation thread, full chunks are handed to a background thread that writes them to disk.
+	// An instruction is recorded before it executes, its memory accesses follow its record.
+	// start() and stop() must not be called while the emulation thread records, call them from the emulation thread or
+	// while it is paused
+	class TraceRecorder
+	{
+	public:
+		enum class RecordType : uint8_t
+		{
+			Instruction,
+			Read,
+			Write
+		};
+
+		struct Record
+		{
+			uint32_t address;		// PC for instructions, bus address for memory accesses
+			uint32_t data;			// opcode for instructions, value for memory accesses
+			uint32_t cyclesLow;		// emulated cycle counter at the start of the instruction, 48 bits in total
+			uint16_t cyclesHigh;
+			RecordType type;
+			uint8_t size;			// access size in bytes, 0 for instructions
+
+			uint64_t cycles() const { return static_cast<uint64_t>(cyclesHigh) << 32 | cyclesLow; }
+		};
+
+		static_assert(sizeof(Record) == 16, "trace record size must be 16 bytes");
+
+		static constexpr uint32_t DefaultChunkSize = 65536;	// records per chunk, 1 MiB
+		static constexpr uint32_t MaxFreeChunks = 4;		// written chunks that are kept for reuse, others are freed
+
+		explicit TraceRecorder(uint32_t _chunkSize = DefaultChunkSize);
+		~TraceRecorder();
+
+		TraceRecorder(const TraceRecorder&) = delete;
+		TraceRecorder& operator = (const TraceRecorder&) = delete;
+
+		bool start(const std::string& _filename);
+		void stop();
+
+		bool isRunning() const { return m_file != nullptr; }
+
+		void addInstruction(const uint32_t _pc, const uint16_t _opcode, const uint64_t _cycles)
+		{
+			add(_pc, _opcode, _cycles, RecordType::Instruction, 0);
+		}
+
+		// drops the last record if it is an instruction, used if the instruction has not been executed
+		void removeLastInstruction()
+		{
+			if(m_writePos != m_chunkBegin && (m_writePos - 1)->type == RecordType::Instruction)
+				--m_writePos;
+		}
+
+		void addRead(const uint32_t _addr, const uint32_t _value, const uint8_t _size, const uint64_t _cycles)
+		{
+			add(_addr, _value, _cycles, RecordType::Read, _size);
+		}
+
+		void addWrite(const uint32_t _addr, const uint32_t _value, const uint8_t _size, const uint64_t _cycles)
+		{
+			add(_addr, _value, _cycles, RecordType::Write, _size);
+		}
+
+		uint64_t getRecordCount() const { return m_recordCount + static_cast<uint64_t>(m_writePos - m_chunkBegin); }
+
+		// Renders a trace file as text, disassembling every recorded instruction via m68k_disassemble. Memory that is
+		// disassembled is read through _mc68k, which therefore needs to have the same code mapped as during recording
+		static bool decode(const std::string& _traceFilename, const std::string& _outFilename, Mc68k& _mc68k);
+
+	private:
+		using Chunk = std::vector<Record>;
+
+		void add(const uint32_t _addr, const uint32_t _data, const uint64_t _cycles, const RecordType _type, const uint8_t _size)
+		{
+			// nothing is recorded before start() and after stop()
+			if(!isRunning())
+				return;
+
+			if(m_writePos == m_chunkEnd)
+				nextChunk();
+
+			auto& r = *m_writePos++;
+			r.address = _addr;
+			r.data = _data;
+			r.cyclesLow = static_cast<uint32_t>(_cycles);
+			r.cyclesHigh = static_cast<uint16_t>(_cycles >> 32);
+			r.type = _type;
+			r.size = _size;
+		}
+
+		void nextChunk();
+		void submitChunk(size_t _recordCount);
+		void threadFunc();
+
+		const uint32_t m_chunkSize;
+
+		FILE* m_file = nullptr;
+
+		std::unique_ptr<Chunk> m_chunk;
+		Record* m_chunkBegin = nullptr;
+		Record* m_chunkEnd = nullptr;
+		Record* m_writePos = nullptr;
+		uint64_t m_recordCount = 0;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::vector<std::pair<std::unique_ptr<Chunk>, size_t>> m_filledChunks;
+		std::vector<std::unique_ptr<Chunk>> m_freeChunks;
+		bool m_stopThread = false;
+		std::unique_ptr<std::thread> m_thread;
+	};
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mc68k
+{
+	// Data watchpoints. Pages that contain a watchpoint are flagged in a bitmap, a data access only needs to test the bits
+	// of the pages of its first and last byte and ranges are only compared for accesses to flagged pages. Opcode and extension word
+	// fetches are not watched
+	class WatchpointMap
+	{
+	public:
+		enum Mode : uint8_t
+		{
+			Read		= 1,
+			Write		= 2,
+			ReadWrite	= Read | Write
+		};
+
+		struct Hit
+		{
+			uint32_t addr = 0;
+			uint32_t size = 0;
+			uint32_t value = 0;
+			bool write = false;
+		};
+
+		static constexpr uint32_t PageShift = 12;
+
+		void add(const uint32_t _addr, const uint32_t _size, const Mode _mode)
+		{
+			m_ranges.push_back({_addr, _size ? _size : 1, _mode});
+			updatePages();
+		}
+
+		void remove(const uint32_t _addr)
+		{
+			for(auto it = m_ranges.begin(); it != m_ranges.end();)
+			{
+				if(it->addr == _addr)
+					it = m_ranges.erase(it);
+				else
+					++it;
+			}
+			updatePages();
+		}
+
+		void clear()
+		{
+			m_ranges.clear();
+			updatePages();
+		}
+
+		bool empty() const { return m_ranges.empty(); }
+
+		bool isWatchedPage(const uint32_t _addr) const
+		{
+			if(!m_pageBits)
+				return false;
+			const auto page = _addr >> PageShift;
+			return (m_pageBits[page >> 3] & (1 << (page & 7))) != 0;
+		}
+
+		// an access crosses at most one page boundary, testing the pages of its first and last byte is sufficient
+		bool isWatchedAccess(const uint32_t _addr, const uint32_t _size) const
+		{
+			return isWatchedPage(_addr) || isWatchedPage(_addr + _size - 1);
+		}
+
+		// true if the access hits a watchpoint, the access is stored as the last hit in this case
+		bool check(const uint32_t _addr, const uint32_t _size, const uint32_t _value, const bool _write)
+		{
+			const auto mode = _write ? Write : Read;
+
+			for (const auto& r : m_ranges)
+			{
+				if(!(r.mode & mode))
+					continue;
+
+				// the ranges overlap if each one starts before the other one ends
+				if(_addr - r.addr < r.size || r.addr - _addr < _size)
+				{
+					m_hit = {_addr, _size, _value, _write};
+					return true;
+				}
+			}
+			return false;
+		}
+
+		const Hit& getHit() const { return m_hit; }
+
+	private:
+		struct Range
+		{
+			uint32_t addr;
+			uint32_t size;
+			Mode mode;
+		};
+
+		void updatePages()
+		{
+			if(m_ranges.empty())
+			{
+				m_pages.clear();
+				m_pageBits = nullptr;
+				return;
+			}
+
+			m_pages.assign((1ull << (32 - PageShift)) / 8, 0);
+
+			for (const auto& r : m_ranges)
+			{
+				const auto first = r.addr >> PageShift;
+				const auto last = static_cast<uint32_t>((static_cast<uint64_t>(r.addr) + r.size - 1) >> PageShift);
+
+				for(uint64_t p = first; p <= last; ++p)
+				{
+					const auto page = static_cast<uint32_t>(p & ((1u << (32 - PageShift)) - 1));
+					m_pages[page >> 3] |= static_cast<uint8_t>(1 << (page & 7));
+				}
+			}
+
+			m_pageBits = m_pages.data();
+		}
+
+		std::vector<Range> m_ranges;
+		std::vector<uint8_t> m_pages;
+		const uint8_t* m_pageBits = nullptr;	// nullptr while there are no watchpoints
+		Hit m_hit;
+	};
+}